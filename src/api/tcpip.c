@@ -91,8 +91,13 @@ again:
   sleeptime = sys_timeouts_sleeptime();
   if (sleeptime == SYS_TIMEOUTS_SLEEPTIME_INFINITE) {
     UNLOCK_TCPIP_CORE();
-    sys_arch_mbox_fetch(mbox, msg, 0);
+    res = sys_arch_mbox_fetch(mbox, msg, 0);
     LOCK_TCPIP_CORE();
+    if (res == SYS_ARCH_TIMEOUT) {
+      /* The port may return without a message, e.g. after handling a driver
+         event, and new timeouts may have been added meanwhile. */
+      goto again;
+    }
     return;
   } else if (sleeptime == 0) {
     sys_check_timeouts();
@@ -608,6 +613,9 @@ tcpip_init(tcpip_init_done_fn initfunc, void *arg)
   if (sys_mbox_new(&tcpip_mbox, TCPIP_MBOX_SIZE) != ERR_OK) {
     LWIP_ASSERT("failed to create tcpip_thread mbox", 0);
   }
+#if SYS_ARCH_TCPIP_EVENTS
+  sys_arch_tcpip_bind(&tcpip_mbox);
+#endif /* SYS_ARCH_TCPIP_EVENTS */
 #if LWIP_TCPIP_CORE_LOCKING
   if (sys_mutex_new(&lock_tcpip_core) != ERR_OK) {
     LWIP_ASSERT("failed to create lock_tcpip_core", 0);
@@ -262,6 +262,8 @@ inet_cksum_pseudo_base(struct pbuf *p, u8_t proto, u16_t proto_len, u32_t acc)
   struct pbuf *q;
   int swapped = 0;
 
+  PERF_START;
+
   /* iterate through all pbuf in chain */
   for (q = p; q != NULL; q = q->next) {
     LWIP_DEBUGF(INET_DEBUG, ("inet_chksum_pseudo(): checksumming pbuf %p (has next %p) \n",
@@ -290,6 +292,7 @@ inet_cksum_pseudo_base(struct pbuf *p, u8_t proto, u16_t proto_len, u32_t acc)
   acc = FOLD_U32T(acc);
   acc = FOLD_U32T(acc);
   LWIP_DEBUGF(INET_DEBUG, ("inet_chksum_pseudo(): pbuf chain lwip_chksum()=%"X32_F"\n", acc));
+  PERF_STOP("inet_chksum_pseudo");
   return (u16_t)~(acc & 0xffffUL);
 }
 
@@ -571,6 +574,8 @@ inet_chksum_pbuf(struct pbuf *p)
   struct pbuf *q;
   int swapped = 0;
 
+  PERF_START;
+
   acc = 0;
   for (q = p; q != NULL; q = q->next) {
     acc += LWIP_CHKSUM(q->payload, q->len);
@@ -584,6 +589,7 @@ inet_chksum_pbuf(struct pbuf *p)
   if (swapped) {
     acc = SWAP_BYTES_IN_WORD(acc);
   }
+  PERF_STOP("inet_chksum_pbuf");
   return (u16_t)~(acc & 0xffffUL);
 }
 
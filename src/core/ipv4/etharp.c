@@ -187,6 +187,30 @@ etharp_free_entry(int i)
 #endif /* LWIP_DEBUG */
 }
 
+#if LWIP_TIMERS_ON_DEMAND
+/**
+ * Returns 1 while there are pending or stable entries that etharp_tmr() has
+ * to age, static entries do not need the timer.
+ */
+u8_t
+etharp_tmr_needed(void)
+{
+  u8_t i;
+
+  for (i = 0; i < ARP_TABLE_SIZE; ++i) {
+    u8_t state = arp_table[i].state;
+    if (state != ETHARP_STATE_EMPTY
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+        && (state != ETHARP_STATE_STATIC)
+#endif /* ETHARP_SUPPORT_STATIC_ENTRIES */
+       ) {
+      return 1;
+    }
+  }
+  return 0;
+}
+#endif /* LWIP_TIMERS_ON_DEMAND */
+
 /**
  * Clears expired entries in the ARP table.
  *
@@ -453,6 +477,9 @@ etharp_update_arp_entry(struct netif *netif, const ip4_addr_t *ipaddr, struct et
   {
     /* mark it stable */
     arp_table[i].state = ETHARP_STATE_STABLE;
+#if LWIP_TIMERS_ON_DEMAND
+    etharp_timer_needed();
+#endif /* LWIP_TIMERS_ON_DEMAND */
   }
 
   /* record network interface */
@@ -966,6 +993,9 @@ etharp_query(struct netif *netif, const ip4_addr_t *ipaddr, struct pbuf *q)
     arp_table[i].state = ETHARP_STATE_PENDING;
     /* record network interface for re-sending arp request in etharp_tmr */
     arp_table[i].netif = netif;
+#if LWIP_TIMERS_ON_DEMAND
+    etharp_timer_needed();
+#endif /* LWIP_TIMERS_ON_DEMAND */
   }
 
   /* { i is either a STABLE or (new or existing) PENDING entry } */
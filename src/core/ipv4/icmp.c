@@ -144,7 +144,8 @@ icmp_input(struct pbuf *p, struct netif *inp)
       }
 #if CHECKSUM_CHECK_ICMP
       IF__NETIF_CHECKSUM_ENABLED(inp, NETIF_CHECKSUM_CHECK_ICMP) {
-        if (inet_chksum_pbuf(p) != 0) {
+        if (PBUF_CHECKSUM_FAILED(p) ||
+            (!PBUF_CHECKSUM_VERIFIED(p) && inet_chksum_pbuf(p) != 0)) {
           LWIP_DEBUGF(ICMP_DEBUG, ("icmp_input: checksum failed for received ICMP echo\n"));
           pbuf_free(p);
           ICMP_STATS_INC(icmp.chkerr);
@@ -429,6 +429,8 @@ ip4_input(struct pbuf *p, struct netif *inp)
 
   LWIP_ASSERT_CORE_LOCKED();
 
+  PERF_START;
+
   IP_STATS_INC(ip.recv);
   MIB2_STATS_INC(mib2.ipinreceives);
 
@@ -488,7 +490,7 @@ ip4_input(struct pbuf *p, struct netif *inp)
   /* verify checksum */
 #if CHECKSUM_CHECK_IP
   IF__NETIF_CHECKSUM_ENABLED(inp, NETIF_CHECKSUM_CHECK_IP) {
-    if (inet_chksum(iphdr, iphdr_hlen) != 0) {
+    if (!PBUF_CHECKSUM_VERIFIED(p) && inet_chksum(iphdr, iphdr_hlen) != 0) {
 
       LWIP_DEBUGF(IP_DEBUG | LWIP_DBG_LEVEL_SERIOUS,
                   ("Checksum (0x%"X16_F") failed, IP packet dropped.\n", inet_chksum(iphdr, iphdr_hlen)));
@@ -629,6 +631,10 @@ ip4_input(struct pbuf *p, struct netif *inp)
 #if IP_REASSEMBLY /* packet fragment reassembly code present? */
     LWIP_DEBUGF(IP_DEBUG, ("IP packet is a fragment (id=0x%04"X16_F" tot_len=%"U16_F" len=%"U16_F" MF=%"U16_F" offset=%"U16_F"), calling ip4_reass()\n",
                            lwip_ntohs(IPH_ID(iphdr)), p->tot_len, lwip_ntohs(IPH_LEN(iphdr)), (u16_t)!!(IPH_OFFSET(iphdr) & PP_HTONS(IP_MF)), (u16_t)((lwip_ntohs(IPH_OFFSET(iphdr)) & IP_OFFMASK) * 8)));
+#if LWIP_CHECKSUM_RX_OFFLOAD
+    /* the MAC has seen a fragment only, the transport checksum is over the datagram */
+    p->flags = (u8_t)(p->flags & ~(PBUF_FLAG_CSUM_OK | PBUF_FLAG_CSUM_BAD));
+#endif /* LWIP_CHECKSUM_RX_OFFLOAD */
     /* reassemble the packet*/
     p = ip4_reass(p);
     /* packet not fully reassembled yet? */
@@ -676,10 +682,15 @@ ip4_input(struct pbuf *p, struct netif *inp)
   ip_data.current_ip4_header = iphdr;
   ip_data.current_ip_header_tot_len = IPH_HL_BYTES(iphdr);
 
+  /* protocols routed to a GI uplink are handed over to the IPv4 module */
+  if (ipv4_proto_input_wrapper(p, inp, iphdr_hlen) == ERR_OK) {
+    MIB2_STATS_INC(mib2.ipindelivers);
+  }
 #if LWIP_RAW
   /* raw input did not eat the packet? */
-  raw_status = raw_input(p, inp);
-  if (raw_status != RAW_INPUT_EATEN)
+  else if ((raw_status = raw_input(p, inp)) != RAW_INPUT_EATEN)
+#else /* LWIP_RAW */
+  else
 #endif /* LWIP_RAW */
   {
     pbuf_remove_header(p, iphdr_hlen); /* Move to payload, no check necessary. */
@@ -691,13 +702,13 @@ ip4_input(struct pbuf *p, struct netif *inp)
       case IP_PROTO_UDPLITE:
 #endif /* LWIP_UDPLITE */
         MIB2_STATS_INC(mib2.ipindelivers);
-        ipv4_udp_input_wrapper(p, inp);
+        udp_input(p, inp);
         break;
 #endif /* LWIP_UDP */
 #if LWIP_TCP
       case IP_PROTO_TCP:
         MIB2_STATS_INC(mib2.ipindelivers);
-        ipv4_tcp_input_wrapper(p, inp);
+        tcp_input(p, inp);
         break;
 #endif /* LWIP_TCP */
 #if LWIP_ICMP
@@ -746,6 +757,7 @@ ip4_input(struct pbuf *p, struct netif *inp)
   ip4_addr_set_any(ip4_current_src_addr());
   ip4_addr_set_any(ip4_current_dest_addr());
 
+  PERF_STOP("ip4_input");
   return ERR_OK;
 }
 
@@ -118,6 +118,18 @@ static u16_t ip_reass_pbufcount;
 static void ip_reass_dequeue_datagram(struct ip_reassdata *ipr, struct ip_reassdata *prev);
 static int ip_reass_free_complete_datagram(struct ip_reassdata *ipr, struct ip_reassdata *prev);
 
+#if LWIP_TIMERS_ON_DEMAND
+/**
+ * Returns 1 while there are datagrams waiting for fragments, so
+ * ip_reass_tmr() has to keep running.
+ */
+u8_t
+ip_reass_tmr_needed(void)
+{
+  return reassdatagrams != NULL;
+}
+#endif /* LWIP_TIMERS_ON_DEMAND */
+
 /**
  * Reassembly timer base function
  * for both NO_SYS == 0 and 1 (!).
@@ -303,6 +315,9 @@ ip_reass_enqueue_new_datagram(struct ip_hdr *fraghdr, int clen)
   /* enqueue the new structure to the front of the list */
   ipr->next = reassdatagrams;
   reassdatagrams = ipr;
+#if LWIP_TIMERS_ON_DEMAND
+  ip_reass_timer_needed();
+#endif /* LWIP_TIMERS_ON_DEMAND */
   /* copy the ip header for later tests and input */
   /* @todo: no ip options supported? */
   SMEMCPY(&(ipr->iphdr), fraghdr, IP_HLEN);
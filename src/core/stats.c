@@ -162,6 +162,9 @@ stats_display(void)
     MEMP_STATS_DISPLAY(i);
   }
   SYS_STATS_DISPLAY();
+#ifdef LWIP_PORT_STATS_DISPLAY
+  LWIP_PORT_STATS_DISPLAY();
+#endif /* LWIP_PORT_STATS_DISPLAY */
 }
 #endif /* LWIP_STATS_DISPLAY */
 
@@ -176,6 +176,82 @@ tcp_timer_needed(void)
 }
 #endif /* LWIP_TCP */
 
+#if LWIP_TIMERS_ON_DEMAND && LWIP_IPV4 && IP_REASSEMBLY
+/** global variable that shows if the reassembly timer is currently scheduled or not */
+static int ip_reass_timer_active;
+
+/**
+ * Timer callback function that calls ip_reass_tmr() and reschedules itself
+ * as long as there are datagrams to reassemble.
+ *
+ * @param arg unused argument
+ */
+static void
+ip_reass_timer(void *arg)
+{
+  LWIP_UNUSED_ARG(arg);
+
+  ip_reass_tmr();
+  if (ip_reass_tmr_needed()) {
+    sys_timeout(IP_TMR_INTERVAL, ip_reass_timer, NULL);
+  } else {
+    ip_reass_timer_active = 0;
+  }
+}
+
+/**
+ * Called when a new datagram is queued for reassembly.
+ */
+void
+ip_reass_timer_needed(void)
+{
+  LWIP_ASSERT_CORE_LOCKED();
+
+  if (!ip_reass_timer_active) {
+    ip_reass_timer_active = 1;
+    sys_timeout(IP_TMR_INTERVAL, ip_reass_timer, NULL);
+  }
+}
+#endif /* LWIP_TIMERS_ON_DEMAND && LWIP_IPV4 && IP_REASSEMBLY */
+
+#if LWIP_TIMERS_ON_DEMAND && LWIP_IPV4 && LWIP_ARP
+/** global variable that shows if the ARP timer is currently scheduled or not */
+static int etharp_timer_active;
+
+/**
+ * Timer callback function that calls etharp_tmr() and reschedules itself
+ * as long as there are entries to age.
+ *
+ * @param arg unused argument
+ */
+static void
+etharp_timer(void *arg)
+{
+  LWIP_UNUSED_ARG(arg);
+
+  etharp_tmr();
+  if (etharp_tmr_needed()) {
+    sys_timeout(ARP_TMR_INTERVAL, etharp_timer, NULL);
+  } else {
+    etharp_timer_active = 0;
+  }
+}
+
+/**
+ * Called when an ARP entry becomes pending or stable.
+ */
+void
+etharp_timer_needed(void)
+{
+  LWIP_ASSERT_CORE_LOCKED();
+
+  if (!etharp_timer_active) {
+    etharp_timer_active = 1;
+    sys_timeout(ARP_TMR_INTERVAL, etharp_timer, NULL);
+  }
+}
+#endif /* LWIP_TIMERS_ON_DEMAND && LWIP_IPV4 && LWIP_ARP */
+
 static void
 #if LWIP_DEBUG_TIMERNAMES
 sys_timeout_abs(u32_t abs_time, sys_timeout_handler handler, void *arg, const char *handler_name)
@@ -266,6 +342,19 @@ void sys_timeouts_init(void)
   size_t i;
   /* tcp_tmr() at index 0 is started on demand */
   for (i = (LWIP_TCP ? 1 : 0); i < LWIP_ARRAYSIZE(lwip_cyclic_timers); i++) {
+#if LWIP_TIMERS_ON_DEMAND && LWIP_IPV4
+    /* ARP and reassembly timers are started on demand as well */
+#if IP_REASSEMBLY
+    if (lwip_cyclic_timers[i].handler == ip_reass_tmr) {
+      continue;
+    }
+#endif /* IP_REASSEMBLY */
+#if LWIP_ARP
+    if (lwip_cyclic_timers[i].handler == etharp_tmr) {
+      continue;
+    }
+#endif /* LWIP_ARP */
+#endif /* LWIP_TIMERS_ON_DEMAND && LWIP_IPV4 */
     /* we have to cast via size_t to get rid of const warning
       (this is OK as cyclic_timer() casts back to const* */
     sys_timeout(lwip_cyclic_timers[i].interval_ms, lwip_cyclic_timer, LWIP_CONST_CAST(void *, &lwip_cyclic_timers[i]));
@@ -448,4 +537,19 @@ void
 tcp_timer_needed(void)
 {
 }
+#if LWIP_TIMERS_ON_DEMAND
+/* Without lwIP's timers ip_reass_tmr() and etharp_tmr() are called cyclically by the application */
+#if LWIP_IPV4 && IP_REASSEMBLY
+void
+ip_reass_timer_needed(void)
+{
+}
+#endif /* LWIP_IPV4 && IP_REASSEMBLY */
+#if LWIP_IPV4 && LWIP_ARP
+void
+etharp_timer_needed(void)
+{
+}
+#endif /* LWIP_IPV4 && LWIP_ARP */
+#endif /* LWIP_TIMERS_ON_DEMAND */
 #endif /* LWIP_TIMERS && !LWIP_TIMERS_CUSTOM */
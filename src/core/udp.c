@@ -333,8 +333,9 @@ udp_input(struct pbuf *p, struct netif *inp)
       } else
 #endif /* LWIP_UDPLITE */
       {
-        if (udphdr->chksum != 0) {
-          if (ip_chksum_pseudo(p, IP_PROTO_UDP, p->tot_len,
+        if (udphdr->chksum != 0 && !PBUF_CHECKSUM_VERIFIED(p)) {
+          if (PBUF_CHECKSUM_FAILED(p) ||
+              ip_chksum_pseudo(p, IP_PROTO_UDP, p->tot_len,
                                ip_current_src_addr(),
                                ip_current_dest_addr()) != 0) {
             goto chkerr;
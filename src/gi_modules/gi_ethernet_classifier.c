@@ -0,0 +1,158 @@
+/*
+ * gi_ethernet_classifier.c
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include "gi_modules/gi_ethernet_classifier.h"
+#include <string.h>
+
+/* Rules are kept in a fixed array and chained per hash bucket by index */
+typedef struct{
+	struct eth_addr dest;		/* all zero for any address */
+	u16_t eth_type;
+	u16_t vlan;
+	s8_t linkId;
+	u8_t trafficClass;
+	s8_t next;
+	u8_t used;
+}ETH_CLASSIFIER_RULE;
+
+static ETH_CLASSIFIER_RULE _rules[ETH_CLASSIFIER_MAX_RULES];
+static s8_t _buckets[ETH_CLASSIFIER_HASH_SIZE];
+
+static const struct eth_addr _macAny = {{0,0,0,0,0,0}};
+
+static u32_t _hash(const struct eth_addr *dest, u16_t eth_type, u16_t vlan){
+	u32_t h = ((u32_t)dest->addr[2] << 24) | ((u32_t)dest->addr[3] << 16) |
+			((u32_t)dest->addr[4] << 8) | dest->addr[5];
+	h ^= ((u32_t)eth_type << 16) | vlan;
+	h ^= h >> 16;
+	h ^= h >> 8;
+	return h & (ETH_CLASSIFIER_HASH_SIZE - 1);
+}
+
+/* Has to be called with interrupts disabled */
+static s8_t _find(const struct eth_addr *dest, u16_t eth_type, u16_t vlan, s8_t **p_prev){
+	s8_t *prev = &_buckets[_hash(dest, eth_type, vlan)];
+	s8_t idx = *prev;
+	while(idx >= 0){
+		ETH_CLASSIFIER_RULE *rule = &_rules[idx];
+		if(rule->eth_type == eth_type && rule->vlan == vlan && eth_addr_cmp(&rule->dest, dest))
+			break;
+		prev = &rule->next;
+		idx = rule->next;
+	}
+	if(p_prev != NULL)
+		*p_prev = prev;
+	return idx;
+}
+
+/**
+ * Init Function
+ */
+void GI_EthClassifier_Init(void){
+	int i;
+	for(i = 0; i < ETH_CLASSIFIER_HASH_SIZE; i++)
+		_buckets[i] = -1;
+	for(i = 0; i < ETH_CLASSIFIER_MAX_RULES; i++)
+		_rules[i].used = 0;
+}
+
+/**
+ * Adds a rule or updates the existing one with the same key.
+ * dest may be ETH_CLASSIFIER_MAC_ANY, vlan ETH_CLASSIFIER_VLAN_ANY,
+ * eth_type is in host byte order.
+ * Returns 0 on success, -1 if the table is full.
+ */
+int GI_EthClassifier_AddRule(const struct eth_addr *dest, u16_t eth_type, u16_t vlan,
+				int linkId, GI_TRAFFIC_CLASS trafficClass){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	s8_t idx;
+	s8_t *prev;
+
+	if(dest == ETH_CLASSIFIER_MAC_ANY)
+		dest = &_macAny;
+
+	OS_ENTER_CRITICAL();
+	idx = _find(dest, eth_type, vlan, &prev);
+	if(idx < 0){
+		for(idx = 0; idx < ETH_CLASSIFIER_MAX_RULES; idx++){
+			if(!_rules[idx].used)
+				break;
+		}
+		if(idx == ETH_CLASSIFIER_MAX_RULES){
+			OS_EXIT_CRITICAL();
+			return -1;
+		}
+		_rules[idx].dest = *dest;
+		_rules[idx].eth_type = eth_type;
+		_rules[idx].vlan = vlan;
+		_rules[idx].used = 1;
+		/* new rules are inserted at the head of the bucket */
+		prev = &_buckets[_hash(dest, eth_type, vlan)];
+		_rules[idx].next = *prev;
+		*prev = idx;
+	}
+	_rules[idx].linkId = (s8_t)linkId;
+	_rules[idx].trafficClass = (u8_t)trafficClass;
+	OS_EXIT_CRITICAL();
+	return 0;
+}
+
+/**
+ * Removes the rule with exactly this key.
+ * Returns 0 on success, -1 if there is no such rule.
+ */
+int GI_EthClassifier_RemoveRule(const struct eth_addr *dest, u16_t eth_type, u16_t vlan){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	s8_t idx;
+	s8_t *prev;
+
+	if(dest == ETH_CLASSIFIER_MAC_ANY)
+		dest = &_macAny;
+
+	OS_ENTER_CRITICAL();
+	idx = _find(dest, eth_type, vlan, &prev);
+	if(idx < 0){
+		OS_EXIT_CRITICAL();
+		return -1;
+	}
+	*prev = _rules[idx].next;
+	_rules[idx].used = 0;
+	OS_EXIT_CRITICAL();
+	return 0;
+}
+
+/**
+ * Returns the link id for a frame or ETH_CLASSIFIER_DROP.
+ * The most specific rule wins: address before any address, VLAN before any VLAN.
+ */
+int GI_EthClassifier_Lookup(const struct eth_addr *dest, u16_t eth_type, u16_t vlan,
+				GI_TRAFFIC_CLASS *trafficClass){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	int linkId = ETH_CLASSIFIER_DROP;
+	s8_t idx;
+
+	OS_ENTER_CRITICAL();
+	idx = _find(dest, eth_type, vlan, NULL);
+	if(idx < 0)
+		idx = _find(dest, eth_type, ETH_CLASSIFIER_VLAN_ANY, NULL);
+	if(idx < 0)
+		idx = _find(&_macAny, eth_type, vlan, NULL);
+	if(idx < 0)
+		idx = _find(&_macAny, eth_type, ETH_CLASSIFIER_VLAN_ANY, NULL);
+	if(idx >= 0){
+		linkId = _rules[idx].linkId;
+		if(trafficClass != NULL)
+			*trafficClass = (GI_TRAFFIC_CLASS)_rules[idx].trafficClass;
+	}
+	OS_EXIT_CRITICAL();
+	return linkId;
+}
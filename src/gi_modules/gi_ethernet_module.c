@@ -6,17 +6,56 @@
  */
 
 #include "gi_modules/gi_ethernet_module.h"
+#include "gi_modules/gi_ipv4_module.h"
+#include "gi_modules/gi_ethernet_classifier.h"
+#include <string.h>
 
-static GI_LINK* links[4];
+/* Queue entries at which a tx link is congested and free again */
+#ifndef ETH_LINK_HIGH_WATER
+#define ETH_LINK_HIGH_WATER				(ETH_LINK_QUEUE_SIZE*3/4)
+#endif
+#ifndef ETH_LINK_LOW_WATER
+#define ETH_LINK_LOW_WATER					(ETH_LINK_QUEUE_SIZE/2)
+#endif
 
+/* Critical frames run to completion on the ethernet task, straight into
+ * ip4_input and udp_input/tcp_input instead of the critical uplink */
+#ifndef ETH_CRITICAL_INLINE
+#define ETH_CRITICAL_INLINE				0
+#endif
+
+/* Stop taking frames from the MAC while an uplink is congested. The frames stay
+ * in the DMA ring and the MAC drops at the wire once it is full, instead of
+ * spending cpu time and pbufs on frames that are dropped later anyway.
+ * Not with inline critical frames, they would wait in the ring as well,
+ * non-critical frames are dropped by the credits of the uplink instead. */
+#ifndef ETH_RX_PAUSE_ON_CONGESTION
+#define ETH_RX_PAUSE_ON_CONGESTION			(!ETH_CRITICAL_INLINE)
+#endif
+
+static GI_LINK* links[ETH_MAX_LINKS];
+static GI_FLOW _ethFlow[ETH_MAX_LINKS];
+static int _ethNumLinks;
+
+#if GI_STATS
+static GI_LINK_STATS *_ethStats[ETH_MAX_LINKS];
+static const char * const _ethStatsName[ETH_MAX_LINKS] = {
+	"eth mac", "eth link1", "eth link2", "eth link3", "eth link4", "eth link5", "eth link6", "eth link7"
+};
+/* post of the pending MAC wakeup, there is only one at a time */
+static u32_t _ethRxWakeupTime;
+#endif /* GI_STATS */
+
+#ifndef ETH_TASK_STACK_SIZE
 #define ETH_TASK_STACK_SIZE				512
+#endif
+#ifndef ETH_TASK_PRIO
 #define ETH_TASK_PRIO						20
+#endif
 #define ETH_TASK_NAME						"Eth Task"
 static OS_STK eth_task_stk[ETH_TASK_STACK_SIZE];
 
-static uint32_t _ethInputBuffer[4*20];
-static ETH_SEND_DATA _ethSendDataMem[4*20];
-static OS_MEM *_ethSendData;
+static uint32_t _ethInputBuffer[ETH_MAX_LINKS*ETH_LINK_QUEUE_SIZE];
 
 static struct netif *ethDev;
 
@@ -28,30 +67,59 @@ static int _ethDownlinkOutputWrapper(void* p_arg1, void* p_arg2);
 static int _ethUplink1Output(void* p_arg1, void* p_arg2);
 static int _ethUplink2Output(void* p_arg1, void* p_arg2);
 static int _ethUplink3Output(void* p_arg1, void* p_arg2);
+#if ETH_CRITICAL_INLINE
+static int _ethUplinkInlineOutput(void* p_arg1, void* p_arg2);
+#endif /* ETH_CRITICAL_INLINE */
+
+static GI_LINK_FKT _ethUplinkOutput[ETH_MAX_LINKS];
+
+/* Credits of the queue behind each uplink, NULL if the uplink never blocks */
+static GI_FLOW *_ethUplinkFlow[ETH_MAX_LINKS];
+
+/* Dispatch priority and rate limit of an uplink. Tokens are frames scaled by
+ * OS_TICKS_PER_SEC, every tick adds rate of them. */
+typedef struct{
+	u8_t prio;					/* lower is dispatched first */
+	u32_t rate;					/* frames per second, 0 for no limit */
+	u32_t bucketSize;
+	u32_t tokens;
+	u32_t lastTick;
+	u32_t drops;
+}ETH_UPLINK_SCHED;
+static ETH_UPLINK_SCHED _ethSched[ETH_MAX_LINKS];
+
+/* Uplink ids sorted by priority */
+static u8_t _ethDispatchOrder[ETH_MAX_LINKS];
+
+static void _ethSortUplinks(void);
+static int _ethPolice(int linkId);
+
+static void _ethUplinkFlowEvent(void *arg, u8_t congested);
+static int _ethRxPaused(void);
+
+/* Set while a wakeup for the MAC downlink is queued, so the rx interrupt
+ * posts only once per burst */
+static volatile uint8_t _ethRxWakeupPending;
 
 /* just to simulate a static arp ip module */
 void testIPInput(struct pbuf *p, struct netif *inp){
 	pbuf_free(p);
 }
 
-typedef enum {
-	DISCARD = 0,
-	IPv4,
-	ARP
-}ETH_TYPE;
-static ETH_TYPE pbuf_data_type = DISCARD;
-static struct pbuf *p_pbuf;
-static struct netif *p_input;
+/* Descriptor of the frame currently inside ethernet_input, only valid on the
+ * ethernet task while the process function runs. Everything after that uses the
+ * descriptor returned by the process function. */
+static GI_PACKET *_ethRxPacket;
+
+static err_t _ethClassify(struct pbuf *p, struct netif *inp, GI_PACKET_TYPE type);
+static int _ethReceive(GI_PACKET **p_pkt);
 
 /**
  * Init Function
  */
 void GI_Ethernet_Init(void *netif){
-	uint8_t err;
 	ethDev = netif;
 
-	_ethSendData = OSMemCreate(_ethSendDataMem,4*20,sizeof(ETH_SEND_DATA),&err);
-
 	GI_TASK_DATA taskData;
 	taskData.p_taskStack = eth_task_stk;
 	taskData.prio = ETH_TASK_PRIO;
@@ -60,14 +128,118 @@ void GI_Ethernet_Init(void *netif){
 	GI_AddInterface(0, NULL, _ethGlobalProcessFunction, _ethRouter, &taskData);
 
 	/* Downlink, Ethernet MAC */
-	links[0] = GI_AddQueueLink(0,0,(void*)&_ethInputBuffer[0*20],20,_ethDownlinkOutputWrapper);
+	links[0] = GI_AddQueueLink(0,0,(void*)&_ethInputBuffer[0*ETH_LINK_QUEUE_SIZE],ETH_LINK_QUEUE_SIZE,_ethDownlinkOutputWrapper);
+	GI_STATS_REGISTER(_ethStats[0], _ethStatsName[0]);
+	_ethNumLinks = 1;
 
 	/* One uplink for critical IP module with static ARP */
-	links[1] = GI_AddQueueLink(0,1,(void*)&_ethInputBuffer[1*20],20, _ethUplink1Output);
+#if ETH_CRITICAL_INLINE
+	GI_IPv4_EnableInline();
+	int critLink = GI_Ethernet_AddUplink(_ethUplinkInlineOutput);
+#else
+	int critLink = GI_Ethernet_AddUplink(_ethUplink1Output);
+#endif /* ETH_CRITICAL_INLINE */
+
+	/* Two uplinks for non-critical IP module with dynamic ARP */
+	int ipLink = GI_Ethernet_AddUplink(_ethUplink2Output);
+	int arpLink = GI_Ethernet_AddUplink(_ethUplink3Output);
+
+	/* Default classification, critical MAC gets no ARP (static ARP), everything
+	 * else goes to the non-critical IP module */
+	struct eth_addr critMac = ETH_ADDR(MAC_ADDR0,MAC_ADDR1,MAC_ADDR2,MAC_ADDR3,0x00,0x02);
+	GI_EthClassifier_Init();
+	GI_EthClassifier_AddRule(&critMac, ETHTYPE_IP, ETH_CLASSIFIER_VLAN_ANY, critLink, GI_CLASS_CRITICAL);
+	GI_EthClassifier_AddRule(&critMac, ETHTYPE_ARP, ETH_CLASSIFIER_VLAN_ANY, ETH_CLASSIFIER_DROP, GI_CLASS_CRITICAL);
+	GI_EthClassifier_AddRule(ETH_CLASSIFIER_MAC_ANY, ETHTYPE_IP, ETH_CLASSIFIER_VLAN_ANY, ipLink, GI_CLASS_NON_CRITICAL);
+	GI_EthClassifier_AddRule(ETH_CLASSIFIER_MAC_ANY, ETHTYPE_ARP, ETH_CLASSIFIER_VLAN_ANY, arpLink, GI_CLASS_NON_CRITICAL);
+
+	/* Critical first, ARP last, no rate limits */
+	GI_Ethernet_SetUplinkSched(critLink, 0, 0, 1);
+	GI_Ethernet_SetUplinkSched(ipLink, 1, 0, 1);
+	GI_Ethernet_SetUplinkSched(arpLink, 2, 0, 1);
 
-	/* Two uplinks for non-critical IP module (links[2]) with dynamic ARP (links[3]) */
-	links[2] = GI_AddQueueLink(0,2,(void*)&_ethInputBuffer[2*20],20, _ethUplink2Output);
-	links[3] = GI_AddQueueLink(0,3,(void*)&_ethInputBuffer[3*20],20, _ethUplink3Output);
+	/* The non-critical uplinks feed the queues of the IPv4 module */
+	GI_Ethernet_SetUplinkFlow(ipLink, GI_IPv4_GetInputFlow(0));
+	GI_Ethernet_SetUplinkFlow(arpLink, GI_IPv4_GetInputFlow(1));
+
+	/* Frames from the IP module, tcp resends what was refused while congested */
+	GI_Flow_SetEvent(&_ethFlow[1], GI_IPv4_TxFlowEvent, NULL);
+}
+
+/**
+ * Adds an uplink to another module, outputFkt gets a chain of GI_PACKETs.
+ * Returns the link id to be used in classifier rules, -1 if all links are used.
+ */
+int GI_Ethernet_AddUplink(GI_LINK_FKT outputFkt){
+	int linkId = _ethNumLinks;
+	if(linkId >= ETH_MAX_LINKS)
+		return -1;
+
+	links[linkId] = GI_AddQueueLink(0,linkId,(void*)&_ethInputBuffer[linkId*ETH_LINK_QUEUE_SIZE],ETH_LINK_QUEUE_SIZE, outputFkt);
+	if(links[linkId] == NULL)
+		return -1;
+	GI_Flow_Init(&_ethFlow[linkId], ETH_LINK_QUEUE_SIZE, ETH_LINK_HIGH_WATER, ETH_LINK_LOW_WATER);
+	GI_STATS_REGISTER(_ethStats[linkId], _ethStatsName[linkId]);
+	_ethUplinkOutput[linkId] = outputFkt;
+	_ethUplinkFlow[linkId] = NULL;
+	/* in the order they are added until configured otherwise */
+	_ethSched[linkId].prio = (u8_t)linkId;
+	_ethSched[linkId].rate = 0;
+	_ethSched[linkId].drops = 0;
+	_ethNumLinks++;
+	_ethSortUplinks();
+	return linkId;
+}
+
+/**
+ * Sets the dispatch priority of an uplink, lower is served first within every
+ * rx burst. rate limits the frames per second with bursts of up to burst
+ * frames, frames above it are dropped before they reach the uplink.
+ * rate 0 removes the limit. Returns 0 on success, -1 on an invalid link.
+ */
+int GI_Ethernet_SetUplinkSched(int linkId, u8_t prio, u32_t rate, u32_t burst){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	if(linkId <= 0 || linkId >= _ethNumLinks)
+		return -1;
+	if(burst == 0)
+		burst = 1;
+
+	OS_ENTER_CRITICAL();
+	_ethSched[linkId].prio = prio;
+	_ethSched[linkId].rate = rate;
+	_ethSched[linkId].bucketSize = burst * OS_TICKS_PER_SEC;
+	_ethSched[linkId].tokens = _ethSched[linkId].bucketSize;
+	_ethSched[linkId].lastTick = OSTimeGet();
+	_ethSortUplinks();
+	OS_EXIT_CRITICAL();
+	return 0;
+}
+
+/**
+ * Returns the number of frames dropped by the rate limit of an uplink
+ */
+u32_t GI_Ethernet_GetUplinkDrops(int linkId){
+	if(linkId <= 0 || linkId >= _ethNumLinks)
+		return 0;
+	return _ethSched[linkId].drops;
+}
+
+/**
+ * Tells the module about the credits of the queue an uplink posts to. While
+ * it is congested no more frames are taken from the MAC, reception resumes
+ * on the low watermark event.
+ */
+int GI_Ethernet_SetUplinkFlow(int linkId, GI_FLOW *flow){
+	if(linkId <= 0 || linkId >= _ethNumLinks)
+		return -1;
+	if(_ethUplinkFlow[linkId] != NULL)
+		GI_Flow_SetEvent(_ethUplinkFlow[linkId], NULL, NULL);
+	_ethUplinkFlow[linkId] = flow;
+	if(flow != NULL)
+		GI_Flow_SetEvent(flow, _ethUplinkFlowEvent, NULL);
+	return 0;
 }
 
 /**
@@ -75,50 +247,90 @@ void GI_Ethernet_Init(void *netif){
  */
 static void* _ethGlobalProcessFunction(void* data, int inputId){
 	if(inputId == 0){
-		/* MAC to ip direction */
-		struct pbuf *p = low_level_input(ethDev);
-		ethernet_input(p,ethDev);
+		/* MAC to ip direction, handled in bursts */
+		GI_PACKET *burst[ETH_RX_BURST_SIZE];
+		GI_PACKET *head[ETH_MAX_LINKS] = {NULL};
+		GI_PACKET *tail[ETH_MAX_LINKS] = {NULL};
+		int count = 0;
+		int i;
+
+		GI_STATS_DEQUEUE(_ethStats[0], _ethRxWakeupTime);
+		_ethRxWakeupPending = 0;
+		if(_ethRxPaused())
+			return NULL;
+
+		/* first pass: fetch and classify, all headers are touched here */
+		while(count < ETH_RX_BURST_SIZE){
+			GI_PACKET *pkt;
+			if(!_ethReceive(&pkt))
+				break;
+			if(pkt != NULL)
+				burst[count++] = pkt;
+		}
+
+		/* second pass: route the whole burst, one chain per uplink */
+		for(i = 0; i < count; i++){
+			int linkId = _ethRouter(burst[i], 0, NULL);
+			if(linkId <= 0)
+				continue;
+			if(!_ethPolice(linkId)){
+				GI_Packet_Drop(burst[i]);
+				continue;
+			}
+			burst[i]->next = NULL;
+			if(head[linkId] == NULL)
+				head[linkId] = burst[i];
+			else
+				tail[linkId]->next = burst[i];
+			tail[linkId] = burst[i];
+		}
+		/* strict priority, the rate limits keep the lower ones from starving */
+		for(i = 0; i < _ethNumLinks - 1; i++){
+			int linkId = _ethDispatchOrder[i];
+			if(head[linkId] != NULL)
+				_ethUplinkOutput[linkId](head[linkId], NULL);
+		}
+
+		/* burst was full, there may be more frames in the DMA ring. Requeue
+		 * instead of looping so tx data on the other links gets its turn.
+		 * A congested uplink requeues by its low watermark event. */
+		if(count == ETH_RX_BURST_SIZE && !_ethRxPaused())
+			ethDownlinkInputFunction(NULL, NULL);
+
+		/* everything is dispatched already, nothing left for the router */
+		return NULL;
 	} else {
-		/* ip to mac direction */
-		ETH_SEND_DATA *p_txdata = (ETH_SEND_DATA *)data;
-		ethernet_output(p_txdata->netif,p_txdata->p,p_txdata->src,p_txdata->dst,p_txdata->eth_type);
-		OSMemPut(_ethSendData,p_txdata);
+		/* ip to mac direction, the pbuf carries its ETH_SEND_DATA */
+		struct pbuf *p = (struct pbuf *)data;
+		if(inputId < ETH_MAX_LINKS)
+			GI_Flow_Return(&_ethFlow[inputId]);
+		ETH_SEND_DATA txdata;
+		GI_Packet_GetSendData(p, &txdata, sizeof(ETH_SEND_DATA));
+		GI_STATS_DEQUEUE(_ethStats[inputId], txdata.enqueueTime);
+		ethernet_output(txdata.netif,p,&txdata.src,&txdata.dst,txdata.eth_type);
+		/* reference taken in ethernet_output_wrapper */
+		pbuf_free(p);
+		return NULL;
 	}
 }
 
 /**
  * Ouput Router Function
  */
-static struct eth_addr addresses[] = {
-		ETH_ADDR(MAC_ADDR0,MAC_ADDR1,MAC_ADDR2,MAC_ADDR3,0x00,0x02),
-		ETH_ADDR(MAC_ADDR0,MAC_ADDR1,MAC_ADDR2,MAC_ADDR3,0x00,0x04),
-};
-
 static int _ethRouter(void* data, int inputId, void* gi_if){
 	if(inputId == 0){
-		/* MAC to IP is routed */
-		struct eth_hdr *ethhdr = (struct eth_hdr *)p_pbuf;
+		/* MAC to IP is routed by the classifier table */
+		GI_PACKET *pkt = (GI_PACKET *)data;
+		if(pkt == NULL)
+			return -1;
 
-		int uplinkMACId = 0;
-		for (uplinkMACId = 0; uplinkMACId < 2; uplinkMACId++){
-			if(eth_addr_cmp(&ethhdr->dest,&addresses[uplinkMACId]))
-				break;
-		}
-		if(uplinkMACId == 0){
-			/* critical traffic with static arp, ignore arp packets */
-			if(pbuf_data_type == ARP){
-				pbuf_free(p_pbuf);
-				return -1;
-			} else {
-				return 1;
-			}
-		} else {
-			if(pbuf_data_type == IPv4){
-				return 2;
-			} else {
-				return 3;
-			}
+		struct eth_hdr *ethhdr = GI_PACKET_ETH_HDR(pkt);
+		int linkId = GI_EthClassifier_Lookup(&ethhdr->dest, pkt->eth_type, pkt->vlan, &pkt->trafficClass);
+		if(linkId <= 0 || linkId >= _ethNumLinks){
+			GI_Packet_Drop(pkt);
+			return -1;
 		}
+		return linkId;
 	} else {
 		/* IP to mac is not routed */
 		return -1;
@@ -134,63 +346,221 @@ static int _ethRouter(void* data, int inputId, void* gi_if){
  * Link Functions
  */
 int ethDownlinkInputFunction(void* p_arg1, void* p_arg2){
-	links[0]->_inputFkt(links[0],NULL);
+	if(_ethRxWakeupPending)
+		return 0;
+	_ethRxWakeupPending = 1;
+	GI_STATS_STAMP(_ethRxWakeupTime);
+	GI_STATS_ENQUEUE(_ethStats[0]);
+	if(links[0]->_inputFkt(links[0],NULL) != 0){
+		GI_STATS_CANCEL(_ethStats[0]);
+		_ethRxWakeupPending = 0;
+		return -1;
+	}
+	return 0;
 }
 
 static int _ethDownlinkOutputWrapper(void* p_arg1, void* p_arg2){
 	// Empty, called low-level-output in ethernet_output
 }
 
+/* The uplink outputs get a chain of packets (linked by next) */
 static int _ethUplink1Output(void* p_arg1, void* p_arg2){
-	struct pbuf *p = (struct pbuf*)p_arg1;
-	pbuf_free(p);
+	GI_PACKET *pkt = (GI_PACKET*)p_arg1;
+	while(pkt != NULL){
+		GI_PACKET *next = pkt->next;
+		testIPInput(pkt->p, pkt->netif);
+		GI_Packet_Free(pkt);
+		pkt = next;
+	}
+	return 0;
 }
 
+#if ETH_CRITICAL_INLINE
+/* No queue hop and no task switch, the IPv4 module runs on this task */
+static int _ethUplinkInlineOutput(void* p_arg1, void* p_arg2){
+	GI_IPv4_InputInline((GI_PACKET*)p_arg1);
+	return 0;
+}
+#endif /* ETH_CRITICAL_INLINE */
+
 static int _ethUplink2Output(void* p_arg1, void* p_arg2){
-	struct netif *netif = ethDev;
-	struct pbuf *p = (struct pbuf*)p_arg1;
-	if (ip4_input_wrapper(p,netif) != ERR_OK )
+	GI_PACKET *pkt = (GI_PACKET*)p_arg1;
+	/* the whole chain takes one queue entry of the IPv4 module */
+	/* refused while the IPv4 input is congested, frames are dropped here
+	 * only if they were taken from the MAC before the event */
+	if (ip4_input_wrapper(pkt) != ERR_OK )
 	{
-		pbuf_free(p);
+		GI_Packet_DropChain(pkt);
 	}
+	return 0;
 }
 
 static int _ethUplink3Output(void* p_arg1, void* p_arg2){
-	struct netif *netif = ethDev;
-	struct pbuf *p = (struct pbuf*)p_arg1;
-	if (etharp_input_wrapper(p,netif) != ERR_OK )
+	GI_PACKET *pkt = (GI_PACKET*)p_arg1;
+	if (etharp_input_wrapper(pkt) != ERR_OK )
 	{
+		GI_Packet_DropChain(pkt);
+	}
+	return 0;
+}
+
+/* Has to be called with interrupts disabled or during init */
+static void _ethSortUplinks(void){
+	int i, j;
+	for(i = 1; i < _ethNumLinks; i++)
+		_ethDispatchOrder[i - 1] = (u8_t)i;
+	for(i = 1; i < _ethNumLinks - 1; i++){
+		u8_t linkId = _ethDispatchOrder[i];
+		for(j = i; j > 0 && _ethSched[_ethDispatchOrder[j - 1]].prio > _ethSched[linkId].prio; j--)
+			_ethDispatchOrder[j] = _ethDispatchOrder[j - 1];
+		_ethDispatchOrder[j] = linkId;
+	}
+}
+
+/* Token bucket of an uplink, returns 0 if the frame exceeds the rate */
+static int _ethPolice(int linkId){
+	ETH_UPLINK_SCHED *sched = &_ethSched[linkId];
+	u32_t now, ticks;
+
+	if(sched->rate == 0)
+		return 1;
+
+	now = OSTimeGet();
+	ticks = now - sched->lastTick;
+	sched->lastTick = now;
+	if(ticks >= sched->bucketSize / sched->rate + 1)
+		sched->tokens = sched->bucketSize;
+	else if(ticks > 0){
+		sched->tokens += ticks * sched->rate;
+		if(sched->tokens > sched->bucketSize)
+			sched->tokens = sched->bucketSize;
+	}
+
+	if(sched->tokens < OS_TICKS_PER_SEC){
+		sched->drops++;
+		return 0;
+	}
+	sched->tokens -= OS_TICKS_PER_SEC;
+	return 1;
+}
+
+/* Low watermark of a downstream queue, start taking frames again */
+static void _ethUplinkFlowEvent(void *arg, u8_t congested){
+	if(!congested)
+		ethDownlinkInputFunction(NULL, NULL);
+}
+
+static int _ethRxPaused(void){
+#if ETH_RX_PAUSE_ON_CONGESTION
+	int i;
+	for(i = 1; i < _ethNumLinks; i++){
+		if(_ethUplinkFlow[i] != NULL && GI_Flow_IsCongested(_ethUplinkFlow[i]))
+			return 1;
+	}
+#endif /* ETH_RX_PAUSE_ON_CONGESTION */
+	return 0;
+}
+
+/**
+ * Fetches one frame from the MAC and classifies it. Returns 0 if the DMA ring
+ * is empty, *p_pkt is NULL if the frame was dropped or consumed.
+ */
+static int _ethReceive(GI_PACKET **p_pkt){
+	GI_PACKET *pkt;
+	struct pbuf *p = low_level_input(ethDev);
+
+	*p_pkt = NULL;
+	if(p == NULL)
+		return 0;
+
+	pkt = GI_Packet_Alloc(p, ethDev);
+	if(pkt == NULL){
+		/* descriptor pool exhausted, counted as a drop of the MAC link */
+		GI_STATS_DROP(_ethStats[0]);
 		pbuf_free(p);
+		return 1;
+	}
+	GI_STATS_STAMP(pkt->rxTime);
+
+	_ethRxPacket = pkt;
+	ethernet_input(p,ethDev);
+	_ethRxPacket = NULL;
+
+	if(pkt->type == GI_PACKET_DISCARD){
+		/* frame was freed or consumed by ethernet_input */
+		GI_Packet_Free(pkt);
+		return 1;
 	}
+	*p_pkt = pkt;
+	return 1;
+}
+
+/**
+ * Records the classification of ethernet_input in the descriptor of the frame,
+ * p->payload already points behind the ethernet (and VLAN) header
+ */
+static err_t _ethClassify(struct pbuf *p, struct netif *inp, GI_PACKET_TYPE type){
+	GI_PACKET *pkt = _ethRxPacket;
+	if(pkt == NULL || pkt->p != p){
+		pbuf_free(p);
+		return ERR_VAL;
+	}
+	pkt->netif = inp;
+	pkt->type = type;
+	pkt->l3_offset = (u16_t)((u8_t*)p->payload - pkt->frame);
+
+	struct eth_hdr *ethhdr = GI_PACKET_ETH_HDR(pkt);
+	pkt->eth_type = lwip_htons(ethhdr->type);
+	pkt->vlan = 0;
+#if ETHARP_SUPPORT_VLAN
+	if(ethhdr->type == PP_HTONS(ETHTYPE_VLAN)){
+		struct eth_vlan_hdr *vlanhdr = (struct eth_vlan_hdr *)(pkt->frame + SIZEOF_ETH_HDR);
+		pkt->eth_type = lwip_htons(vlanhdr->tpid);
+		pkt->vlan = VLAN_ID(vlanhdr);
+	}
+#endif /* ETHARP_SUPPORT_VLAN */
+	return ERR_OK;
 }
 
 err_t eth_ip4_input_wrapper(struct pbuf *p, struct netif *inp){
-	p_pbuf =  p;
-	p_input = inp;
-	pbuf_data_type = IPv4;
+	return _ethClassify(p, inp, GI_PACKET_IPV4);
 }
 
 err_t eth_etharp_input_wrapper(struct pbuf *p, struct netif *inp){
-	p_pbuf = p;
-	p_input = inp;
-	pbuf_data_type = ARP;
+	return _ethClassify(p, inp, GI_PACKET_ARP);
 }
 
+/**
+ * Queues a frame for the ethernet task without any allocation, the metadata
+ * goes into the pbuf headroom. Like ethernet_output the caller keeps its
+ * reference to p, ERR_WOULDBLOCK is returned as soon as the tx link is
+ * congested. tcp keeps the segment on unsent and GI_IPv4_TxFlowEvent reruns
+ * tcp_output once the link is below the low watermark again.
+ */
 err_t ethernet_output_wrapper(struct netif * netif, struct pbuf * p,
 				const struct eth_addr * src, const struct eth_addr * dst,
 				u16_t eth_type){
-	uint8_t err;
-	ETH_SEND_DATA *p_data = OSMemGet(_ethSendData, &err);
-	if(p_data != (ETH_SEND_DATA*)0){
-		p_data->netif = netif;
-		p_data->p = p;
-		p_data->src = src;
-		p_data->dst = dst;
-		p_data->eth_type = eth_type;
-		links[1]->_inputFkt(links[1],p_data);
-		return ERR_OK;
-	} else {
+	ETH_SEND_DATA txdata;
+	txdata.netif = netif;
+	txdata.src = *src;
+	txdata.dst = *dst;
+	txdata.eth_type = eth_type;
+	GI_STATS_STAMP(txdata.enqueueTime);
+	if(GI_Packet_PutSendData(p, &txdata, sizeof(ETH_SEND_DATA)) != 0)
+		return ERR_BUF;
+
+	if(GI_Flow_Take(&_ethFlow[1], GI_CLASS_NON_CRITICAL) != 0){
+		/* link is congested, let the caller back off */
+		GI_STATS_DROP(_ethStats[1]);
+		return ERR_WOULDBLOCK;
+	}
+	pbuf_ref(p);
+	GI_STATS_ENQUEUE(_ethStats[1]);
+	if(links[1]->_inputFkt(links[1],p) != 0){
+		GI_STATS_CANCEL(_ethStats[1]);
 		pbuf_free(p);
-		return ERR_MEM;
+		GI_Flow_Return(&_ethFlow[1]);
+		return ERR_WOULDBLOCK;
 	}
+	return ERR_OK;
 }
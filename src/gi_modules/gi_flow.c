@@ -0,0 +1,92 @@
+/*
+ * gi_flow.c
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include "gi_modules/gi_flow.h"
+
+/**
+ * Init Function, the event function is left as it is, the upstream module
+ * may have registered it before the link was created
+ */
+void GI_Flow_Init(GI_FLOW *flow, u16_t size, u16_t highWater, u16_t lowWater){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	if(highWater > size)
+		highWater = size;
+	if(lowWater >= highWater)
+		lowWater = highWater > 0 ? highWater - 1 : 0;
+
+	OS_ENTER_CRITICAL();
+	flow->size = size;
+	flow->credits = size;
+	flow->highWater = highWater;
+	flow->lowWater = lowWater;
+	flow->congested = 0;
+	OS_EXIT_CRITICAL();
+}
+
+/**
+ * Registers the function notified on congestion changes, NULL to remove it
+ */
+void GI_Flow_SetEvent(GI_FLOW *flow, GI_FLOW_EVENT_FKT eventFkt, void *arg){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	OS_ENTER_CRITICAL();
+	flow->eventFkt = eventFkt;
+	flow->eventArg = arg;
+	OS_EXIT_CRITICAL();
+}
+
+/**
+ * Takes a credit before posting to the link.
+ * Returns 0 on success, -1 if the sender has to back off.
+ */
+int GI_Flow_Take(GI_FLOW *flow, GI_TRAFFIC_CLASS trafficClass){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	u8_t raised = 0;
+
+	OS_ENTER_CRITICAL();
+	if(flow->credits == 0 || (flow->congested && trafficClass != GI_CLASS_CRITICAL)){
+		OS_EXIT_CRITICAL();
+		return -1;
+	}
+	flow->credits--;
+	if(!flow->congested && flow->size - flow->credits >= flow->highWater){
+		flow->congested = 1;
+		raised = 1;
+	}
+	OS_EXIT_CRITICAL();
+
+	if(raised && flow->eventFkt != NULL)
+		flow->eventFkt(flow->eventArg, 1);
+	return 0;
+}
+
+/**
+ * Gives a credit back, called by the receiving module for every dequeued
+ * entry and by the sender if the post failed nevertheless
+ */
+void GI_Flow_Return(GI_FLOW *flow){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	u8_t cleared = 0;
+
+	OS_ENTER_CRITICAL();
+	if(flow->credits < flow->size)
+		flow->credits++;
+	if(flow->congested && flow->size - flow->credits <= flow->lowWater){
+		flow->congested = 0;
+		cleared = 1;
+	}
+	OS_EXIT_CRITICAL();
+
+	if(cleared && flow->eventFkt != NULL)
+		flow->eventFkt(flow->eventArg, 0);
+}
@@ -6,21 +6,66 @@
  */
 
 #include "gi_modules/gi_ipv4_module.h"
-
-static GI_LINK* links[4];
-
+#include "lwip/udp.h"
+#include "lwip/priv/tcp_priv.h"
+#include "lwip/etharp.h"
+#include "lwip/tcpip.h"
+#include "gi_modules/gi_flow.h"
+
+/* Max. number of links, the two downlinks and the uplinks */
+#ifndef IPV4_MAX_LINKS
+#define IPV4_MAX_LINKS						8
+#endif
+#define IPV4_LINK_QUEUE_SIZE				20
+
+/* Queue entries at which a link is congested and free again */
+#ifndef IPV4_LINK_HIGH_WATER
+#define IPV4_LINK_HIGH_WATER				(IPV4_LINK_QUEUE_SIZE*3/4)
+#endif
+#ifndef IPV4_LINK_LOW_WATER
+#define IPV4_LINK_LOW_WATER				(IPV4_LINK_QUEUE_SIZE/2)
+#endif
+
+/* Priority of the lock taken by the IPv4 task and by inline callers, has to be
+ * free and above all tasks that take it (priority inheritance) */
+#ifndef IPV4_INLINE_LOCK_PRIO
+#define IPV4_INLINE_LOCK_PRIO				19
+#endif
+
+/* Max. number of UDP/TCP port range rules */
+#ifndef IPV4_MAX_PORT_RULES
+#define IPV4_MAX_PORT_RULES				8
+#endif
+
+static GI_LINK* links[IPV4_MAX_LINKS];
+static GI_FLOW _ipv4Flow[IPV4_MAX_LINKS];
+static int _ipv4NumLinks;
+
+#if GI_STATS
+static GI_LINK_STATS *_ipv4Stats[IPV4_MAX_LINKS];
+static const char * const _ipv4StatsName[IPV4_MAX_LINKS] = {
+	"ipv4 in", "ipv4 arp", "ipv4 link2", "ipv4 link3", "ipv4 link4", "ipv4 link5", "ipv4 link6", "ipv4 link7"
+};
+/* udp_input and tcp_input run on the IPv4 task, latency from the MAC */
+static GI_LINK_STATS *_ipv4UdpInputStats;
+static GI_LINK_STATS *_ipv4TcpInputStats;
+#endif /* GI_STATS */
+
+#ifndef IPV4_TASK_STACK_SIZE
 #define IPV4_TASK_STACK_SIZE				512
+#endif
+#ifndef IPV4_TASK_PRIO
 #define IPV4_TASK_PRIO						21
+#endif
 #define IPV4_TASK_NAME						"IPv4 Task"
 static OS_STK ipv4_task_stk[IPV4_TASK_STACK_SIZE];
 
-static uint32_t _ipv4InputBuffer[4*20];
-static IPv4_SEND_DATA _ipv4SendDataMem[4*20];
-static OS_MEM *_ipv4SendData;
+static uint32_t _ipv4InputBuffer[IPV4_MAX_LINKS*IPV4_LINK_QUEUE_SIZE];
 
 static struct netif *ethDev;
 
 static void* _ipv4GlobalProcessFunction(void* data, int inputId);
+static void* _ipv4Process(void* data, int inputId);
 static int _ipv4Router(void* data, int inputId, void* gi_if);
 
 static int _ipv4DownlinkOutputWrapper(void* p_arg1, void* p_arg2);
@@ -29,24 +74,43 @@ static int _ipv4Downlink2OutputWrapper(void* p_arg1, void* p_arg2);
 static int _ipv4UdpLinkOutput(void* p_arg1, void* p_arg2);
 static int _ipv4TcpLinkOutput(void* p_arg1, void* p_arg2);
 
-typedef enum {
-	DISCARD = 0,
-	UDP,
-	TCP
-}IP_TYPE;
-static IP_TYPE pbuf_data_type = DISCARD;
-static struct pbuf *p_pbuf;
-static struct netif *p_input;
+static GI_LINK_FKT _ipv4UplinkOutput[IPV4_MAX_LINKS];
+
+/* Protocol demux: uplink per IP protocol number or IPV4_LINK_LOCAL */
+static s8_t _ipv4ProtoLink[256];
+
+/* Port range rules for UDP and TCP, checked before the protocol table */
+typedef struct{
+	u8_t used;
+	u8_t proto;
+	s8_t linkId;
+	u16_t portLow;
+	u16_t portHigh;
+}IPV4_PORT_RULE;
+static IPV4_PORT_RULE _ipv4PortRules[IPV4_MAX_PORT_RULES];
+static u8_t _ipv4NumPortRules;
+
+/* Descriptor of the packet currently inside ip4_input, only valid on the
+ * IPv4 task while the process function runs */
+static GI_PACKET *_ipv4RxPacket;
+
+/* Serializes the IPv4 task and inline callers inside lwIP, NULL as long as
+ * nobody calls GI_IPv4_InputInline */
+static OS_EVENT *_ipv4InlineLock;
+
+/* Set while a tcp_output pass is queued for the core, so a burst of low
+ * watermark events posts only once */
+static volatile u8_t _ipv4TcpKickPending;
+
+static int _ipv4Route(u8_t proto, u16_t port);
+static void _ipv4Input(GI_PACKET *pkt);
 
 /**
  * Init Function
  */
 void GI_IPv4_Init(void *netif){
-	uint8_t err;
 	ethDev = netif;
 
-	_ipv4SendData = OSMemCreate(_ipv4SendDataMem,4*20,sizeof(IPv4_SEND_DATA),&err);
-
 	GI_TASK_DATA taskData;
 	taskData.p_taskStack = ipv4_task_stk;
 	taskData.prio = IPV4_TASK_PRIO;
@@ -54,46 +118,265 @@ void GI_IPv4_Init(void *netif){
 
 	GI_AddInterface(0, NULL, _ipv4GlobalProcessFunction, _ipv4Router, &taskData);
 
-	/* Downlink, ETH Module */
-	links[0] = GI_AddQueueLink(1,0,(void*)&_ipv4InputBuffer[0*20],20,_ipv4DownlinkOutputWrapper);
-	links[1] = GI_AddQueueLink(1,1,(void*)&_ipv4InputBuffer[1*20],20,_ipv4Downlink2OutputWrapper);
+	/* Downlinks, ETH Module: IPv4 (links[0]) and ARP (links[1]) */
+	links[0] = GI_AddQueueLink(1,0,(void*)&_ipv4InputBuffer[0*IPV4_LINK_QUEUE_SIZE],IPV4_LINK_QUEUE_SIZE,_ipv4DownlinkOutputWrapper);
+	links[1] = GI_AddQueueLink(1,1,(void*)&_ipv4InputBuffer[1*IPV4_LINK_QUEUE_SIZE],IPV4_LINK_QUEUE_SIZE,_ipv4Downlink2OutputWrapper);
+	GI_Flow_Init(&_ipv4Flow[0], IPV4_LINK_QUEUE_SIZE, IPV4_LINK_HIGH_WATER, IPV4_LINK_LOW_WATER);
+	GI_Flow_Init(&_ipv4Flow[1], IPV4_LINK_QUEUE_SIZE, IPV4_LINK_HIGH_WATER, IPV4_LINK_LOW_WATER);
+	GI_STATS_REGISTER(_ipv4Stats[0], _ipv4StatsName[0]);
+	GI_STATS_REGISTER(_ipv4Stats[1], _ipv4StatsName[1]);
+	GI_STATS_REGISTER(_ipv4UdpInputStats, "udp input");
+	GI_STATS_REGISTER(_ipv4TcpInputStats, "tcp input");
+	_ipv4NumLinks = 2;
+
+	/* Everything else stays with lwIP (icmp, igmp, raw) until routed */
+	int i;
+	for(i = 0; i < 256; i++)
+		_ipv4ProtoLink[i] = IPV4_LINK_LOCAL;
+	_ipv4NumPortRules = 0;
+
+	/* One uplink for UDP module */
+	GI_IPv4_SetProtocolLink(IP_PROTO_UDP, GI_IPv4_AddUplink(_ipv4UdpLinkOutput));
+
+	/* One uplink for TCP module */
+	GI_IPv4_SetProtocolLink(IP_PROTO_TCP, GI_IPv4_AddUplink(_ipv4TcpLinkOutput));
+
+	/* Send path of udp (link 2) and tcp (link 3), segments refused while
+	 * congested are sent again once the link is free */
+	GI_Flow_SetEvent(&_ipv4Flow[2], GI_IPv4_TxFlowEvent, NULL);
+	GI_Flow_SetEvent(&_ipv4Flow[3], GI_IPv4_TxFlowEvent, NULL);
+}
+
+/**
+ * Adds an uplink to another module, outputFkt gets a chain of GI_PACKETs with
+ * p->payload behind the IP header and has to free them.
+ * Returns the link id, -1 if all links are used.
+ */
+int GI_IPv4_AddUplink(GI_LINK_FKT outputFkt){
+	int linkId = _ipv4NumLinks;
+	if(linkId >= IPV4_MAX_LINKS)
+		return -1;
+
+	links[linkId] = GI_AddQueueLink(1,linkId,(void*)&_ipv4InputBuffer[linkId*IPV4_LINK_QUEUE_SIZE],IPV4_LINK_QUEUE_SIZE, outputFkt);
+	if(links[linkId] == NULL)
+		return -1;
+	GI_Flow_Init(&_ipv4Flow[linkId], IPV4_LINK_QUEUE_SIZE, IPV4_LINK_HIGH_WATER, IPV4_LINK_LOW_WATER);
+	GI_STATS_REGISTER(_ipv4Stats[linkId], _ipv4StatsName[linkId]);
+	_ipv4UplinkOutput[linkId] = outputFkt;
+	_ipv4NumLinks++;
+	return linkId;
+}
 
+/**
+ * Returns the credits of an input link, so the sending module can register
+ * for congestion events. The storage is static, this works before GI_IPv4_Init.
+ */
+GI_FLOW* GI_IPv4_GetInputFlow(int linkId){
+	if(linkId < 0 || linkId >= IPV4_MAX_LINKS)
+		return NULL;
+	return &_ipv4Flow[linkId];
+}
 
-	/* One uplink for UDP module ARP */
-	links[2] = GI_AddQueueLink(1,1,(void*)&_ipv4InputBuffer[2*20],20, _ipv4UdpLinkOutput);
+/**
+ * Routes all packets of an IP protocol to an uplink,
+ * IPV4_LINK_LOCAL leaves them to lwIP.
+ */
+int GI_IPv4_SetProtocolLink(u8_t proto, int linkId){
+	if(linkId != IPV4_LINK_LOCAL && (linkId < 2 || linkId >= _ipv4NumLinks))
+		return -1;
+	_ipv4ProtoLink[proto] = (s8_t)linkId;
+	return 0;
+}
 
-	/* One uplink for TCP module ARP */
-	links[3] = GI_AddQueueLink(1,2,(void*)&_ipv4InputBuffer[3*20],20, _ipv4TcpLinkOutput);
+/**
+ * Routes UDP or TCP packets with a destination port in [portLow, portHigh]
+ * to an uplink, e.g. for a dedicated real-time module.
+ * Returns 0 on success, -1 on invalid arguments or if the rule table is full.
+ */
+int GI_IPv4_AddPortRule(u8_t proto, u16_t portLow, u16_t portHigh, int linkId){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	int i;
+
+	if((proto != IP_PROTO_UDP && proto != IP_PROTO_TCP) || portLow > portHigh)
+		return -1;
+	if(linkId != IPV4_LINK_LOCAL && (linkId < 2 || linkId >= _ipv4NumLinks))
+		return -1;
+
+	OS_ENTER_CRITICAL();
+	for(i = 0; i < IPV4_MAX_PORT_RULES; i++){
+		if(!_ipv4PortRules[i].used){
+			_ipv4PortRules[i].proto = proto;
+			_ipv4PortRules[i].portLow = portLow;
+			_ipv4PortRules[i].portHigh = portHigh;
+			_ipv4PortRules[i].linkId = (s8_t)linkId;
+			_ipv4PortRules[i].used = 1;
+			_ipv4NumPortRules++;
+			OS_EXIT_CRITICAL();
+			return 0;
+		}
+	}
+	OS_EXIT_CRITICAL();
+	return -1;
+}
+
+/**
+ * Removes a port range rule added with GI_IPv4_AddPortRule.
+ * Returns 0 on success, -1 if there is no such rule.
+ */
+int GI_IPv4_RemovePortRule(u8_t proto, u16_t portLow, u16_t portHigh){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	int i;
+
+	OS_ENTER_CRITICAL();
+	for(i = 0; i < IPV4_MAX_PORT_RULES; i++){
+		if(_ipv4PortRules[i].used && _ipv4PortRules[i].proto == proto &&
+				_ipv4PortRules[i].portLow == portLow && _ipv4PortRules[i].portHigh == portHigh){
+			_ipv4PortRules[i].used = 0;
+			_ipv4NumPortRules--;
+			OS_EXIT_CRITICAL();
+			return 0;
+		}
+	}
+	OS_EXIT_CRITICAL();
+	return -1;
+}
+
+/**
+ * Creates the lock for GI_IPv4_InputInline, called once by the module that
+ * wants to bypass the queue. Returns 0 on success.
+ */
+int GI_IPv4_EnableInline(void){
+	INT8U err;
+	if(_ipv4InlineLock != NULL)
+		return 0;
+	_ipv4InlineLock = OSMutexCreate(IPV4_INLINE_LOCK_PRIO, &err);
+	return (err == OS_ERR_NONE) ? 0 : -1;
+}
+
+/**
+ * Run-to-completion input: processes a chain like the IPv4 task, but on the
+ * task of the caller, straight into ip4_input and the uplinks (udp_input,
+ * tcp_input). Blocks at most for one entry of the IPv4 task, which inherits
+ * the lock priority meanwhile.
+ */
+void GI_IPv4_InputInline(GI_PACKET *pkt){
+	INT8U err;
+	if(_ipv4InlineLock == NULL){
+		GI_Packet_DropChain(pkt);
+		return;
+	}
+	OSMutexPend(_ipv4InlineLock, 0, &err);
+	_ipv4Input(pkt);
+	OSMutexPost(_ipv4InlineLock);
 }
 
 /**
  * Process Function
  */
 static void* _ipv4GlobalProcessFunction(void* data, int inputId){
+	void *result;
+	INT8U err;
+
+	/* the entry has left the queue */
+	if(inputId >= 0 && inputId < IPV4_MAX_LINKS)
+		GI_Flow_Return(&_ipv4Flow[inputId]);
+
+	if(_ipv4InlineLock != NULL)
+		OSMutexPend(_ipv4InlineLock, 0, &err);
+	result = _ipv4Process(data, inputId);
+	if(_ipv4InlineLock != NULL)
+		OSMutexPost(_ipv4InlineLock);
+	return result;
+}
+
+static void* _ipv4Process(void* data, int inputId){
 	if(inputId == 0){
-		/* IP to TCPUDP direction */
-//		struct pbuf *p = low_level_input(ethDev);
-//		ethernet_input(p,ethDev);
+		/* IP to TCPUDP direction, data is a burst chain of the ethernet module */
+		GI_PACKET *pkt = (GI_PACKET *)data;
+		GI_STATS_DEQUEUE(_ipv4Stats[0], pkt->enqueueTime);
+		_ipv4Input(pkt);
+		/* everything is dispatched already, nothing left for the router */
+		return NULL;
+	} else if(inputId == 1){
+		/* ARP, answered directly */
+		GI_PACKET *pkt = (GI_PACKET *)data;
+		GI_STATS_DEQUEUE(_ipv4Stats[1], pkt->enqueueTime);
+		while(pkt != NULL){
+			GI_PACKET *next = pkt->next;
+			etharp_input(pkt->p,pkt->netif);
+			GI_Packet_Free(pkt);
+			pkt = next;
+		}
+		return NULL;
 	} else {
-		/* TCPUDP to IP direction */
-//		ETH_SEND_DATA *p_txdata = (ETH_SEND_DATA *)data;
-//		ethernet_output(p_txdata->netif,p_txdata->p,p_txdata->src,p_txdata->dst,p_txdata->eth_type);
+		/* TCPUDP to IP direction, the pbuf carries its IPv4_SEND_DATA */
+		struct pbuf *p = (struct pbuf *)data;
+		IPv4_SEND_DATA txdata;
+		GI_Packet_GetSendData(p, &txdata, sizeof(IPv4_SEND_DATA));
+		GI_STATS_DEQUEUE(_ipv4Stats[inputId], txdata.enqueueTime);
+		ip4_output_if_src(p,&txdata.src,txdata.hdrincl ? LWIP_IP_HDRINCL : &txdata.dest,
+				txdata.ttl,txdata.tos,txdata.proto,txdata.netif);
+		/* reference taken in ip4_output_wrapper */
+		pbuf_free(p);
+		return NULL;
+	}
+}
+
+/* Runs a chain through ip4_input and hands the routed packets to the uplinks */
+static void _ipv4Input(GI_PACKET *pkt){
+	GI_PACKET *head[IPV4_MAX_LINKS] = {NULL};
+	GI_PACKET *tail[IPV4_MAX_LINKS] = {NULL};
+	int i;
+
+	while(pkt != NULL){
+		GI_PACKET *next = pkt->next;
+		int linkId;
+
+		_ipv4RxPacket = pkt;
+		pkt->type = GI_PACKET_DISCARD;
+		ip4_input(pkt->p,pkt->netif);
+		_ipv4RxPacket = NULL;
+
+		if(pkt->type == GI_PACKET_DISCARD){
+			/* packet was freed or consumed by lwIP in ip4_input (not routed) */
+			GI_Packet_Free(pkt);
+		} else {
+			linkId = _ipv4Router(pkt, 0, NULL);
+			if(linkId > 1){
+				pkt->next = NULL;
+				if(head[linkId] == NULL)
+					head[linkId] = pkt;
+				else
+					tail[linkId]->next = pkt;
+				tail[linkId] = pkt;
+			}
+		}
+		pkt = next;
+	}
+
+	for(i = 2; i < _ipv4NumLinks; i++){
+		if(head[i] != NULL)
+			_ipv4UplinkOutput[i](head[i], NULL);
 	}
 }
 
 static int _ipv4Router(void* data, int inputId, void* gi_if){
 	if(inputId == 0){
-		/* IP to UDPTCP is routed */
-		struct ip_hdr *iphdr = (struct ip_hdr *)p_pbuf;
-		switch(iphdr->_proto){
-		case IP_PROTO_UDP:
-			return 1;
-		case IP_PROTO_TCP:
-			return 2;
-		default:
-			pbuf_free(p_pbuf);
+		/* IP to upper layers, classified by ipv4_proto_input_wrapper */
+		GI_PACKET *pkt = (GI_PACKET *)data;
+		if(pkt == NULL)
+			return -1;
+
+		int linkId = pkt->ip_link;
+		if(linkId < 2 || linkId >= _ipv4NumLinks){
+			GI_Packet_Drop(pkt);
 			return -1;
 		}
+		return linkId;
 	} else {
 		/* down is not routed??? */
 		return -1;
@@ -109,12 +392,29 @@ static int _ipv4Router(void* data, int inputId, void* gi_if){
  * Link Functions
  */
 
-err_t ip4_input_wrapper(struct pbuf *p, struct netif *inp){
-	return (err_t)links[0]->_inputFkt(p,inp);
+/* Posts a chain of the ethernet module, the class of the chain decides
+ * whether it still gets a credit above the high watermark */
+static err_t _ipv4Post(int linkId, GI_PACKET *pkt){
+	if(GI_Flow_Take(&_ipv4Flow[linkId], pkt->trafficClass) != 0){
+		GI_STATS_DROP(_ipv4Stats[linkId]);
+		return ERR_WOULDBLOCK;
+	}
+	GI_STATS_STAMP(pkt->enqueueTime);
+	GI_STATS_ENQUEUE(_ipv4Stats[linkId]);
+	if(links[linkId]->_inputFkt(links[linkId],pkt) != 0){
+		GI_STATS_CANCEL(_ipv4Stats[linkId]);
+		GI_Flow_Return(&_ipv4Flow[linkId]);
+		return ERR_WOULDBLOCK;
+	}
+	return ERR_OK;
+}
+
+err_t ip4_input_wrapper(GI_PACKET *pkt){
+	return _ipv4Post(0, pkt);
 }
 
-err_t etharp_input_wrapper(struct pbuf *p, struct netif *inp){
-	return (err_t)links[1]->_inputFkt(p,inp);
+err_t etharp_input_wrapper(GI_PACKET *pkt){
+	return _ipv4Post(1, pkt);
 }
 
 static int _ipv4DownlinkOutputWrapper(void* p_arg1, void* p_arg2){
@@ -126,67 +426,215 @@ static int _ipv4Downlink2OutputWrapper(void* p_arg1, void* p_arg2){
 }
 
 
+/* udp_input and tcp_input take addresses and header from ip_data, which
+ * ip4_input has already cleared when the uplink runs */
+static void _ipv4RestoreIpData(GI_PACKET *pkt){
+	ip_data = pkt->ip_data;
+}
+
+static void _ipv4ClearIpData(void){
+	ip_data.current_netif = NULL;
+	ip_data.current_input_netif = NULL;
+	ip_data.current_ip4_header = NULL;
+	ip_data.current_ip_header_tot_len = 0;
+	ip4_addr_set_any(ip4_current_src_addr());
+	ip4_addr_set_any(ip4_current_dest_addr());
+}
+
+/* The uplink outputs get a chain of packets (linked by next) */
 static int _ipv4UdpLinkOutput(void* p_arg1, void* p_arg2){
-	struct netif *netif = ethDev;
-	struct pbuf *p = (struct pbuf*)p_arg1;
-	if (udp_input(p,netif) != ERR_OK )
-	{
-		pbuf_free(p);
+	GI_PACKET *pkt = (GI_PACKET*)p_arg1;
+	while(pkt != NULL){
+		GI_PACKET *next = pkt->next;
+		_ipv4RestoreIpData(pkt);
+		GI_STATS_DEQUEUE(_ipv4UdpInputStats, pkt->rxTime);
+		udp_input(pkt->p,pkt->netif);
+		GI_Packet_Free(pkt);
+		pkt = next;
 	}
+	_ipv4ClearIpData();
+	return 0;
 }
 
 static int _ipv4TcpLinkOutput(void* p_arg1, void* p_arg2){
-	struct netif *netif = ethDev;
-	struct pbuf *p = (struct pbuf*)p_arg1;
-	if (tcp_input(p,netif) != ERR_OK )
-	{
-		pbuf_free(p);
+	GI_PACKET *pkt = (GI_PACKET*)p_arg1;
+	while(pkt != NULL){
+		GI_PACKET *next = pkt->next;
+		_ipv4RestoreIpData(pkt);
+		GI_STATS_DEQUEUE(_ipv4TcpInputStats, pkt->rxTime);
+		tcp_input(pkt->p,pkt->netif);
+		GI_Packet_Free(pkt);
+		pkt = next;
+	}
+	_ipv4ClearIpData();
+	return 0;
+}
+
+/**
+ * Returns the uplink for a protocol and destination port, O(1) unless there
+ * are port rules for UDP/TCP
+ */
+static int _ipv4Route(u8_t proto, u16_t port){
+	if(_ipv4NumPortRules > 0 && (proto == IP_PROTO_UDP || proto == IP_PROTO_TCP)){
+		int i;
+		for(i = 0; i < IPV4_MAX_PORT_RULES; i++){
+			IPV4_PORT_RULE *rule = &_ipv4PortRules[i];
+			if(rule->used && rule->proto == proto && port >= rule->portLow && port <= rule->portHigh)
+				return rule->linkId;
+		}
 	}
+	return _ipv4ProtoLink[proto];
 }
 
-err_t ipv4_udp_input_wrapper(struct pbuf *p, struct netif *inp){
-	p_pbuf =  p;
-	p_input = inp;
-	pbuf_data_type = UDP;
+/**
+ * Called by ip4_input with ip_data set up and p->payload at the IP header.
+ * Takes the packet if its protocol is routed to an uplink and records the
+ * classification in the descriptor, otherwise lwIP goes on as usual.
+ */
+err_t ipv4_proto_input_wrapper(struct pbuf *p, struct netif *inp, u16_t iphdr_hlen){
+	GI_PACKET *pkt = _ipv4RxPacket;
+	const struct ip_hdr *iphdr = ip4_current_header();
+	u8_t proto = IPH_PROTO(iphdr);
+	u16_t port = 0;
+	int linkId;
+
+	if(pkt == NULL){
+		/* not received through the GI path (e.g. loopback) */
+		return ERR_VAL;
+	}
+
+	if((proto == IP_PROTO_UDP || proto == IP_PROTO_TCP) && p->len >= iphdr_hlen + 4){
+		/* destination port is at the same offset for UDP and TCP */
+		u8_t *l4hdr = (u8_t*)p->payload + iphdr_hlen;
+		port = (u16_t)((l4hdr[2] << 8) | l4hdr[3]);
+	}
+	linkId = _ipv4Route(proto, port);
+	if(linkId < 2)
+		return ERR_VAL;
+
+	if(pkt->p != p){
+		/* reassembled by ip4_reass, the fragments are gone */
+		pkt->p = p;
+		pkt->frame = (u8_t*)p->payload;
+		pkt->l3_offset = 0;
+	}
+	pbuf_remove_header(p, iphdr_hlen);
+
+	switch(proto){
+	case IP_PROTO_UDP:
+		pkt->type = GI_PACKET_UDP;
+		break;
+	case IP_PROTO_TCP:
+		pkt->type = GI_PACKET_TCP;
+		break;
+	case IP_PROTO_ICMP:
+		pkt->type = GI_PACKET_ICMP;
+		break;
+	case IP_PROTO_IGMP:
+		pkt->type = GI_PACKET_IGMP;
+		break;
+	default:
+		pkt->type = GI_PACKET_IP;
+		break;
+	}
+	pkt->netif = inp;
+	pkt->ip_proto = proto;
+	pkt->ip_link = (s8_t)linkId;
+	pkt->dst_port = port;
+	pkt->l4_offset = (u16_t)((u8_t*)p->payload - pkt->frame);
+	pkt->ip_data = ip_data;
+	return ERR_OK;
 }
 
-err_t ipv4_tcp_input_wrapper(struct pbuf *p, struct netif *inp){
-	p_pbuf = p;
-	p_input = inp;
-	pbuf_data_type = TCP;
+/**
+ * Runs tcp_output for every active pcb with unsent data, in core context
+ */
+static void _ipv4TcpKick(void *arg){
+	struct tcp_pcb *pcb;
+	LWIP_UNUSED_ARG(arg);
+
+	_ipv4TcpKickPending = 0;
+	for(pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next){
+		if(pcb->unsent != NULL)
+			tcp_output(pcb);
+	}
 }
 
+/**
+ * Low watermark event of the send links (IPv4 udp/tcp and ethernet tx).
+ * tcp_output keeps a segment refused with ERR_WOULDBLOCK on unsent, without
+ * this it would wait for the next ACK or the RTO. Runs on the task that
+ * returned the credit, so tcp_output is deferred into the core.
+ */
+void GI_IPv4_TxFlowEvent(void *arg, u8_t congested){
+	LWIP_UNUSED_ARG(arg);
+	if(congested || _ipv4TcpKickPending)
+		return;
+	_ipv4TcpKickPending = 1;
+#if NO_SYS
+	_ipv4TcpKick(NULL);
+#else
+	if(tcpip_try_callback(_ipv4TcpKick, NULL) != ERR_OK)
+		_ipv4TcpKickPending = 0;
+#endif /* NO_SYS */
+}
+
+/**
+ * Queues a packet for the IPv4 task without any allocation, the metadata goes
+ * into the pbuf headroom. Like ip4_output_if the caller keeps its reference
+ * to p. ERR_WOULDBLOCK is returned as soon as the link is congested, tcp_output
+ * keeps the segment on unsent and GI_IPv4_TxFlowEvent reruns it once the link
+ * is below the low watermark again.
+ */
 err_t ip4_output_wrapper(struct pbuf *p, const ip4_addr_t *src, const ip4_addr_t *dest,
                   u8_t ttl, u8_t tos,
-                  u8_t proto, GI_LINK* gi_link)
+                  u8_t proto, struct netif *netif, int linkId)
 {
-	uint8_t err;
-	IPv4_SEND_DATA *p_data = OSMemGet(_ipv4SendData, &err);
-	if(p_data != (IPv4_SEND_DATA*)0){
-		p_data->p = p;
-		p_data->src = src;
-		p_data->dest = dest;
-		p_data->ttl = ttl;
-		p_data->tos = tos;
-		p_data->proto = proto;
-		gi_link->_inputFkt(gi_link,p_data);
-		return ERR_OK;
-	} else {
+	GI_LINK *gi_link = links[linkId];
+	GI_FLOW *flow = &_ipv4Flow[linkId];
+
+	IPv4_SEND_DATA txdata;
+	txdata.netif = netif;
+	txdata.hdrincl = (dest == LWIP_IP_HDRINCL);
+	if(src != NULL)
+		ip4_addr_copy(txdata.src, *src);
+	else
+		ip4_addr_set_any(&txdata.src);
+	if(!txdata.hdrincl)
+		ip4_addr_copy(txdata.dest, *dest);
+	txdata.ttl = ttl;
+	txdata.tos = tos;
+	txdata.proto = proto;
+	GI_STATS_STAMP(txdata.enqueueTime);
+	if(GI_Packet_PutSendData(p, &txdata, sizeof(IPv4_SEND_DATA)) != 0)
+		return ERR_BUF;
+
+	if(GI_Flow_Take(flow, GI_CLASS_NON_CRITICAL) != 0){
+		/* link is congested, let the caller back off */
+		GI_STATS_DROP(_ipv4Stats[linkId]);
+		return ERR_WOULDBLOCK;
+	}
+	pbuf_ref(p);
+	GI_STATS_ENQUEUE(_ipv4Stats[linkId]);
+	if(gi_link->_inputFkt(gi_link,p) != 0){
+		GI_STATS_CANCEL(_ipv4Stats[linkId]);
 		pbuf_free(p);
-		return ERR_MEM;
+		GI_Flow_Return(flow);
+		return ERR_WOULDBLOCK;
 	}
+	return ERR_OK;
 }
 
 err_t ip4_output_wrapper_udp(struct pbuf *p, const ip4_addr_t *src, const ip4_addr_t *dest,
                   u8_t ttl, u8_t tos,
                   u8_t proto, struct netif *netif){
-	ip4_output_wrapper(p,src,dest,ttl,tos,proto,links[1]);
+	return ip4_output_wrapper(p,src,dest,ttl,tos,proto,netif,2);
 }
 
 err_t ip4_output_wrapper_tcp(struct pbuf *p, const ip4_addr_t *src, const ip4_addr_t *dest,
         u8_t ttl, u8_t tos,
         u8_t proto, struct netif *netif){
-	ip4_output_wrapper(p,src,dest,ttl,tos,proto,links[2]);
+	return ip4_output_wrapper(p,src,dest,ttl,tos,proto,netif,3);
 }
 
 
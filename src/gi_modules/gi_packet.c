@@ -0,0 +1,90 @@
+/*
+ * gi_packet.c
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include "gi_modules/gi_packet.h"
+#include "gi_modules/gi_ethernet_module.h"
+#include <string.h>
+
+static GI_PACKET _giPacketMem[GI_PACKET_POOL_SIZE];
+static OS_MEM *_giPacketPool;
+
+/**
+ * Init Function
+ */
+void GI_Packet_Init(void){
+	uint8_t err;
+	_giPacketPool = OSMemCreate(_giPacketMem,GI_PACKET_POOL_SIZE,sizeof(GI_PACKET),&err);
+}
+
+/**
+ * Takes a descriptor from the pool, the frame is expected to start at p->payload
+ */
+GI_PACKET* GI_Packet_Alloc(struct pbuf *p, struct netif *netif){
+	uint8_t err;
+	GI_PACKET *pkt = OSMemGet(_giPacketPool, &err);
+	if(pkt != (GI_PACKET*)0){
+		pkt->next = NULL;
+		pkt->p = p;
+		pkt->netif = netif;
+		pkt->type = GI_PACKET_DISCARD;
+		pkt->trafficClass = GI_CLASS_NON_CRITICAL;
+		pkt->eth_type = 0;
+		pkt->vlan = 0;
+		pkt->frame = (u8_t*)p->payload;
+		pkt->l3_offset = 0;
+		pkt->l4_offset = 0;
+		pkt->ip_proto = 0;
+		pkt->ip_link = -1;
+		pkt->dst_port = 0;
+	}
+	return pkt;
+}
+
+/**
+ * Returns the descriptor only, the pbuf has been passed on or freed already
+ */
+void GI_Packet_Free(GI_PACKET *pkt){
+	OSMemPut(_giPacketPool, pkt);
+}
+
+/**
+ * Frees pbuf and descriptor
+ */
+void GI_Packet_Drop(GI_PACKET *pkt){
+	pbuf_free(pkt->p);
+	OSMemPut(_giPacketPool, pkt);
+}
+
+/**
+ * Frees all packets of a chain
+ */
+void GI_Packet_DropChain(GI_PACKET *pkt){
+	while(pkt != NULL){
+		GI_PACKET *next = pkt->next;
+		GI_Packet_Drop(pkt);
+		pkt = next;
+	}
+}
+
+/**
+ * Stores send metadata in the headroom right in front of p->payload, so the
+ * pbuf itself can be the queue entry of a send link. The payload is not moved.
+ * Returns 0 on success, -1 if there is not enough headroom.
+ */
+int GI_Packet_PutSendData(struct pbuf *p, const void *data, u16_t len){
+	if(pbuf_add_header(p, len) != 0)
+		return -1;
+	MEMCPY(p->payload, data, len);
+	pbuf_remove_header(p, len);
+	return 0;
+}
+
+/**
+ * Reads back send metadata stored by GI_Packet_PutSendData
+ */
+void GI_Packet_GetSendData(struct pbuf *p, void *data, u16_t len){
+	MEMCPY(data, (u8_t*)p->payload - len, len);
+}
@@ -0,0 +1,166 @@
+/*
+ * gi_stats.c
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include "gi_modules/gi_stats.h"
+#include <string.h>
+
+#if GI_STATS
+
+static GI_LINK_STATS _giStats[GI_STATS_MAX_LINKS];
+static int _giNumStats;
+
+/* Index of the highest set bit plus one, 0 for 0 */
+static int _histBin(u32_t latency){
+	int bin = 0;
+	while(latency != 0 && bin < GI_STATS_HIST_BINS - 1){
+		latency >>= 1;
+		bin++;
+	}
+	return bin;
+}
+
+/**
+ * Init Function
+ */
+void GI_Stats_Init(void){
+	memset(_giStats, 0, sizeof(_giStats));
+	_giNumStats = 0;
+}
+
+/**
+ * Returns the statistics of a new link, NULL if all are used.
+ * Only called during init of the modules.
+ */
+GI_LINK_STATS* GI_Stats_Register(const char *name){
+	GI_LINK_STATS *stats;
+	if(_giNumStats >= GI_STATS_MAX_LINKS)
+		return NULL;
+	stats = &_giStats[_giNumStats++];
+	memset(stats, 0, sizeof(GI_LINK_STATS));
+	stats->name = name;
+	stats->latencyMin = 0xFFFFFFFF;
+	return stats;
+}
+
+/**
+ * Counts a successful post to the link
+ */
+void GI_Stats_Enqueue(GI_LINK_STATS *stats){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	if(stats == NULL)
+		return;
+	OS_ENTER_CRITICAL();
+	stats->enqueued++;
+	stats->depth++;
+	if(stats->depth > stats->maxDepth)
+		stats->maxDepth = stats->depth;
+	OS_EXIT_CRITICAL();
+}
+
+/**
+ * Counts an entry taken by the process function, enqueueTime is the
+ * GI_STATS_TIME of the post. Synchronous hops without a queue use it as well,
+ * they only count dequeues and the latency from their start time.
+ */
+void GI_Stats_Dequeue(GI_LINK_STATS *stats, u32_t enqueueTime){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	u32_t latency = GI_STATS_TIME() - enqueueTime;
+	int bin = _histBin(latency);
+
+	if(stats == NULL)
+		return;
+	OS_ENTER_CRITICAL();
+	stats->dequeued++;
+	if(stats->depth > 0)
+		stats->depth--;
+	if(latency < stats->latencyMin)
+		stats->latencyMin = latency;
+	if(latency > stats->latencyMax)
+		stats->latencyMax = latency;
+	stats->latencySum += latency;
+	stats->hist[bin]++;
+	OS_EXIT_CRITICAL();
+}
+
+/**
+ * Counts a refused post
+ */
+void GI_Stats_Drop(GI_LINK_STATS *stats){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	if(stats == NULL)
+		return;
+	OS_ENTER_CRITICAL();
+	stats->drops++;
+	OS_EXIT_CRITICAL();
+}
+
+/**
+ * Takes back an enqueue whose post failed and counts it as drop
+ */
+void GI_Stats_Cancel(GI_LINK_STATS *stats){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	if(stats == NULL)
+		return;
+	OS_ENTER_CRITICAL();
+	stats->enqueued--;
+	if(stats->depth > 0)
+		stats->depth--;
+	stats->drops++;
+	OS_EXIT_CRITICAL();
+}
+
+/**
+ * Copies the statistics of all links, each one is consistent in itself.
+ * Returns the number of links copied.
+ */
+int GI_Stats_Snapshot(GI_LINK_STATS *buf, int maxLinks){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	int i;
+	int count = _giNumStats < maxLinks ? _giNumStats : maxLinks;
+
+	for(i = 0; i < count; i++){
+		OS_ENTER_CRITICAL();
+		buf[i] = _giStats[i];
+		OS_EXIT_CRITICAL();
+	}
+	return count;
+}
+
+/**
+ * Clears counters, latencies and high watermarks, the current depth is kept
+ */
+void GI_Stats_Reset(void){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	int i;
+
+	for(i = 0; i < _giNumStats; i++){
+		GI_LINK_STATS *stats = &_giStats[i];
+		OS_ENTER_CRITICAL();
+		stats->enqueued = 0;
+		stats->dequeued = 0;
+		stats->drops = 0;
+		stats->maxDepth = stats->depth;
+		stats->latencyMin = 0xFFFFFFFF;
+		stats->latencyMax = 0;
+		stats->latencySum = 0;
+		memset(stats->hist, 0, sizeof(stats->hist));
+		OS_EXIT_CRITICAL();
+	}
+}
+
+#endif /* GI_STATS */
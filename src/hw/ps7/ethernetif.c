@@ -92,9 +92,19 @@ struct xtopology_t xtopology[2];
 struct xemac_s XEMAC;
 xemacpsif_s XEMACPSIF;
 
+#ifndef ETH_INPUT_TASK_STACK_SIZE
 #define ETH_INPUT_TASK_STACK_SIZE				512
+#endif
+#ifndef ETH_INPUT_TASK_PRIO
 #define ETH_INPUT_TASK_PRIO						20
+#endif
 #define ETH_INPUT_TASK_NAME						"Eth Input Task"
+/* Max. frames handed to ethernet_input per event, so API messages are not starved */
+#define ETH_INPUT_EVENT_BUDGET					16
+
+#if SYS_ARCH_TCPIP_EVENTS
+static void xemacif_input_event(void *arg);
+#endif
 
 /*
  * this function is always called with interrupts off
@@ -218,7 +228,14 @@ static err_t low_level_init(struct netif *netif)
 	netif->flags |= NETIF_FLAG_IGMP;
 #endif
 
+#if SYS_ARCH_TCPIP_EVENTS
+	/* the tcpip_thread takes the frames from recv_q itself */
+	xemacpsif->rx_event = sys_arch_tcpip_event_new(xemacif_input_event, (void*)netif);
+	if (xemacpsif->rx_event < 0)
+		return ERR_MEM;
+#else
 	sys_thread_new(ETH_INPUT_TASK_NAME, xemacif_input_thread, (void*)netif, ETH_INPUT_TASK_STACK_SIZE, ETH_INPUT_TASK_PRIO);
+#endif
 
 	XEmacPs_CfgInitialize(&xemacpsif->emacps, XPAR_XEMACPS_0_BASEADDR);
 
@@ -424,6 +441,39 @@ xemacif_input_thread(struct netif *netif)
 	}
 }
 
+#if SYS_ARCH_TCPIP_EVENTS
+/*
+ * Runs in the tcpip_thread with the core locked whenever the receive handler has queued frames,
+ * so they go to ethernet_input directly. If there are more than ETH_INPUT_EVENT_BUDGET frames,
+ * the event is signaled again and the rest is handled after the pending API messages.
+ */
+static void
+xemacif_input_event(void *arg)
+{
+	struct netif *netif = (struct netif *)arg;
+	struct pbuf *p;
+	xemacpsif_s *xemacpsif = &XEMACPSIF;
+	int budget = ETH_INPUT_EVENT_BUDGET;
+
+	while (sys_arch_mbox_tryfetch((sys_mbox_t*)&xemacpsif->recv_q, (void*)&p) != SYS_MBOX_EMPTY) {
+		if (p == NULL) {
+			continue;
+		}
+	#if LINK_STATS
+		lwip_stats.link.recv++;
+	#endif /* LINK_STATS */
+		if (ethernet_input(p, netif) != ERR_OK) {
+			LWIP_DEBUGF(NETIF_DEBUG, ("xemacpsif_input: IP input error\r\n"));
+			pbuf_free(p);
+		}
+		if (--budget == 0) {
+			sys_arch_tcpip_event_signal(xemacpsif->rx_event);
+			break;
+		}
+	}
+}
+#endif /* SYS_ARCH_TCPIP_EVENTS */
+
 void xemacif_isr_wrapper(void* data, uint32_t x){
 	XEmacPs_IntrHandler(&XEMACPSIF.emacps);
 }
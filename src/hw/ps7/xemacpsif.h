@@ -108,6 +108,11 @@ typedef struct {
 
 	unsigned int last_rx_frms_cntr;
 
+#if SYS_ARCH_TCPIP_EVENTS
+	/* tcpip_thread event signaled for every frame put into recv_q */
+	int rx_event;
+#endif
+
 } xemacpsif_s;
 
 extern xemacpsif_s xemacpsif;
@@ -207,7 +207,12 @@ void process_sent_bds(xemacpsif_s *xemacpsif, XEmacPs_BdRing *txring)
 			dsb();
 			p = (struct pbuf *)tx_pbufs_storage[index + bdindex];
 			if (p != NULL) {
+#if SYS_ARCH_PBUF_FREE_DEFER
+				/* runs in the TX done interrupt, the chain is freed in the tcpip_thread */
+				sys_arch_pbuf_free_fromisr(p);
+#else
 				pbuf_free(p);
+#endif
 			}
 			tx_pbufs_storage[index + bdindex] = 0;
 			curbdpntr = XEmacPs_BdRingNext(txring, curbdpntr);
@@ -476,7 +481,7 @@ void emacps_recv_handler(void *arg)
 			/* store it in the receive queue,
 			 * where it'll be processed by a different handler
 			 */
-			if(OSQPost((OS_EVENT*)xemacpsif->recv_q,(void*)p) != OS_ERR_NONE){
+			if(sys_mbox_trypost_fromisr((sys_mbox_t*)&xemacpsif->recv_q,(void*)p) != ERR_OK){
 //			if (pq_enqueue(xemacpsif->recv_q, (void*)p) < 0) {
 #if LINK_STATS
 				lwip_stats.link.memerr++;
@@ -484,6 +489,11 @@ void emacps_recv_handler(void *arg)
 #endif
 				pbuf_free(p);
 			}
+#if SYS_ARCH_TCPIP_EVENTS
+			else {
+				sys_arch_tcpip_event_signal(xemacpsif->rx_event);
+			}
+#endif
 			curbdptr = XEmacPs_BdRingNext( rxring, curbdptr);
 		}
 		/* free up the BD's */
@@ -50,6 +50,7 @@
 #include "lwip/opt.h"
 #include "netif/etharp.h"
 #include "ethernetif.h"
+#include "ethernetif_cache.h"
 #include <string.h>
 
 #include "lwip/timeouts.h"
@@ -62,8 +63,12 @@
 /* The time to block waiting for input. */
 #define TIME_WAITING_FOR_INPUT                 ( 0 )
 /* Stack size of the interface thread */
+#ifndef ETH_INPUT_TASK_STACK_SIZE
 #define ETH_INPUT_TASK_STACK_SIZE				512
+#endif
+#ifndef ETH_INPUT_TASK_PRIO
 #define ETH_INPUT_TASK_PRIO						20
+#endif
 #define ETH_INPUT_TASK_NAME						"Eth Input Task"
 
 OS_STK eth_input_task_stk[ETH_INPUT_TASK_STACK_SIZE];
@@ -201,6 +206,10 @@ void HAL_ETH_MspInit(ETH_HandleTypeDef *heth)
 void HAL_ETH_RxCpltCallback(ETH_HandleTypeDef *heth)
 {
 	rxTimestampTemp = TB_GetTimeLong();
+#if ETH_RX_POLL
+	/* ETHInputTask polls until the ring is empty and unmasks it again */
+	__HAL_ETH_DMA_DISABLE_IT(heth, ETH_DMA_IT_R);
+#endif /* ETH_RX_POLL */
 	OSSemPost(newEthPacketSem);
 }
 
@@ -210,6 +219,11 @@ void HAL_ETH_TxCpltCallback(ETH_HandleTypeDef *heth)
 		txTimestamp = TB_GetTimeLong();
 		triggerTxTimestamp = 0;
 	}
+#if ETH_ZERO_COPY_TX
+	/* ETHInputTask releases the sent frames */
+	if (ethernetif_tx_complete())
+		OSSemPost(newEthPacketSem);
+#endif /* ETH_ZERO_COPY_TX */
 }
 
 /*******************************************************************************
@@ -226,6 +240,10 @@ static void low_level_init(struct netif *netif)
 {
   uint8_t macaddress[6]= { MAC_ADDR0, MAC_ADDR1, MAC_ADDR2, MAC_ADDR3, MAC_ADDR4, MAC_ADDR5 };
   uint8_t err;
+  int prio = sys_arch_thread_prio(ETH_INPUT_TASK_NAME, ETH_INPUT_TASK_PRIO);
+#if ETH_RX_COALESCE_WDT
+  int i;
+#endif
   
   EthHandle.Instance = ETH;  
   EthHandle.Init.MACAddr = macaddress;
@@ -246,9 +264,21 @@ static void low_level_init(struct netif *netif)
   
   /* Initialize Tx Descriptors list: Chain Mode */
   HAL_ETH_DMATxDescListInit(&EthHandle, DMATxDscrTab, &Tx_Buff[0][0], ETH_TXBUFNB);
+#if ETH_ZERO_COPY_TX
+  ethernetif_tx_init();
+#endif /* ETH_ZERO_COPY_TX */
      
   /* Initialize Rx Descriptors list: Chain Mode  */
   HAL_ETH_DMARxDescListInit(&EthHandle, DMARxDscrTab, &Rx_Buff[0][0], ETH_RXBUFNB);
+#if ETH_ZERO_COPY_RX
+  ethernetif_rx_init();
+#endif /* ETH_ZERO_COPY_RX */
+#if ETH_RX_COALESCE_WDT
+  /* Interrupt by the receive watchdog instead of per frame */
+  for (i = 0; i < ETH_RXBUFNB; i++)
+    DMARxDscrTab[i].ControlBufferSize |= ETH_DMARXDESC_DIC;
+  EthHandle.Instance->DMARSWTR = ETH_RX_COALESCE_WDT;
+#endif /* ETH_RX_COALESCE_WDT */
   
   /* set netif MAC hardware address length */
   netif->hwaddr_len = ETHARP_HWADDR_LEN;
@@ -267,21 +297,26 @@ static void low_level_init(struct netif *netif)
   /* Accept broadcast address and ARP traffic */
   netif->flags |= NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
 
+  /* The MAC inserts the IPv4 header and TCP checksums (ETH_CHECKSUM_BY_HARDWARE). UDP and ICMP
+   * are still generated in software, the MAC does not insert them into fragmented datagrams. */
+  NETIF_SET_CHECKSUM_CTRL(netif, NETIF_CHECKSUM_ENABLE_ALL & ~(NETIF_CHECKSUM_GEN_IP | NETIF_CHECKSUM_GEN_TCP));
+
   /* create a binary semaphore used for informing ethernetif of frame reception */
   newEthPacketSem = OSSemCreate(1);
 
   OSTaskCreateExt( ETHInputTask,                              /* Create the start task                                */
                    (void*)netif,
                   &eth_input_task_stk[ETH_INPUT_TASK_STACK_SIZE - 1],
-                   ETH_INPUT_TASK_PRIO,
-				   ETH_INPUT_TASK_PRIO,
+                   prio,
+				   prio,
                   &eth_input_task_stk[0],
 				  ETH_INPUT_TASK_STACK_SIZE,
                    0,
                   (OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR));
+  sys_arch_thread_register(ETH_INPUT_TASK_NAME, prio, ETH_INPUT_TASK_STACK_SIZE);
 
 #if (OS_TASK_NAME_EN > 0)
-    OSTaskNameSet(ETH_INPUT_TASK_PRIO,(INT8U *)ETH_INPUT_TASK_NAME,&err);
+    OSTaskNameSet(prio,(INT8U *)ETH_INPUT_TASK_NAME,&err);
 #endif
 
   /* Enable MAC and DMA transmission and reception */
@@ -325,6 +360,28 @@ static uint8_t low_level_check_link_state(ETH_HandleTypeDef *heth, struct netif
 
 }
 
+#if NETIF_DO_TIMESTAMPING == 0
+/**
+  * @brief Takes the software TX timestamp for UDP frames from or to port 2468
+  *
+  * @param buffer the start of the frame
+  * @param framelength the bytes of the frame in buffer
+  */
+static void low_level_tx_timestamp(uint8_t *buffer, uint32_t framelength)
+{
+    if(framelength > 42){	/* Min UDP Size */
+    	if(((buffer[12] << 8) | buffer[13]) == 0x0800){	/* IP */
+    		if(buffer[23] == 17){ /* UDP */
+    			if(((buffer[34] << 8) | buffer[35]) == 2468 || ((buffer[36] << 8) | buffer[37]) == 2468){
+    				triggerTxTimestamp = 1;
+    				txTimestamp = TB_GetTimeLong();
+    			}
+    		}
+    	}
+    }
+}
+#endif
+
 /**
   * @brief This function should do the actual transmission of the packet. The packet is
   * contained in the pbuf that is passed to the function. This pbuf
@@ -340,6 +397,17 @@ static uint8_t low_level_check_link_state(ETH_HandleTypeDef *heth, struct netif
   *       to become available since the stack doesn't retry to send a packet
   *       dropped because of memory failure (except for the TCP timers).
   */
+#if ETH_ZERO_COPY_TX
+static err_t low_level_output(struct netif *netif, struct pbuf *p)
+{
+#if NETIF_DO_TIMESTAMPING == 0
+  /* The headers are in the first pbuf */
+  low_level_tx_timestamp((uint8_t *)p->payload, p->len);
+#endif
+  /* Point the transmit descriptors into the pbufs, the frame is referenced until it is sent */
+  return ethernetif_tx_send(p);
+}
+#else
 static err_t low_level_output(struct netif *netif, struct pbuf *p)
 {
   err_t errval;
@@ -399,20 +467,11 @@ static err_t low_level_output(struct netif *netif, struct pbuf *p)
   }
 
 #if NETIF_DO_TIMESTAMPING == 0
-    if(framelength > 42){	/* Min UDP Size */
-    	if(((buffer[12] << 8) | buffer[13]) == 0x0800){	/* IP */
-    		if(buffer[23] == 17){ /* UDP */
-    			if(((buffer[34] << 8) | buffer[35]) == 2468 || ((buffer[36] << 8) | buffer[37]) == 2468){
-    				triggerTxTimestamp = 1;
-    				txTimestamp = TB_GetTimeLong();
-    			}
-    		}
-    	}
-    }
+  low_level_tx_timestamp(buffer, framelength);
 #endif
 
-  /* Clean and Invalidate data cache */
-  SCB_CleanInvalidateDCache();  
+  /* Clean the data cache lines written above */
+  ethernetif_cache_tx(EthHandle.TxDesc, framelength);
   /* Prepare transmit descriptors to give to DMA */ 
   HAL_ETH_TransmitFrame(&EthHandle, framelength);
   
@@ -431,6 +490,7 @@ error:
   }
   return errval;
 }
+#endif /* ETH_ZERO_COPY_TX */
 
 /**
   * @brief Should allocate a pbuf and transfer the bytes of the incoming
@@ -450,6 +510,7 @@ static struct pbuf * low_level_input(struct netif *netif)
   uint32_t payloadoffset = 0;
   uint32_t byteslefttocopy = 0;
   uint32_t i=0;
+  uint8_t zeroCopy = 0;
   
   /* get received frame */
   if(HAL_ETH_GetReceivedFrame_IT(&EthHandle) != HAL_OK)
@@ -461,14 +522,21 @@ static struct pbuf * low_level_input(struct netif *netif)
   
   if (len > 0)
   {
-    /* We allocate a pbuf chain of pbufs from the Lwip buffer pool */
-    p = pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
+    /* Clean and Invalidate the data cache lines of the frame */
+    ethernetif_cache_rx(EthHandle.RxFrameInfos.FSRxDesc, EthHandle.RxFrameInfos.SegCount, len);
+#if ETH_ZERO_COPY_RX
+    /* Hand the DMA buffer itself up if possible, copy otherwise */
+    p = ethernetif_rx_take();
+    zeroCopy = (p != NULL);
+#endif /* ETH_ZERO_COPY_RX */
+    if (!zeroCopy)
+    {
+      /* We allocate a pbuf chain of pbufs from the Lwip buffer pool */
+      p = pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
+    }
   }
   
-  /* Clean and Invalidate data cache */
-  SCB_CleanInvalidateDCache();
-  
-  if (p != NULL)
+  if (p != NULL && !zeroCopy)
   {
     dmarxdesc = EthHandle.RxFrameInfos.FSRxDesc;
     bufferoffset = 0;
@@ -512,6 +580,12 @@ static struct pbuf * low_level_input(struct netif *netif)
     }
 #endif
     
+#if LWIP_CHECKSUM_RX_OFFLOAD
+  /* Pass the checksum check of the MAC on, read before the descriptors are released */
+  if (p != NULL)
+    ethernetif_rx_checksum(p);
+#endif /* LWIP_CHECKSUM_RX_OFFLOAD */
+
   /* Release descriptors to DMA */
   /* Point to first descriptor */
   dmarxdesc = EthHandle.RxFrameInfos.FSRxDesc;
@@ -536,6 +610,51 @@ static struct pbuf * low_level_input(struct netif *netif)
   return p;
 }
 
+#if ETH_RX_POLL
+/**
+  * @brief Polling phase of ETHInputTask, entered with the RX interrupt masked.
+  * Takes at most ETH_RX_POLL_BUDGET frames per poll and polls again after a tick
+  * until the ring was found empty ETH_RX_POLL_IDLE times in a row, then unmasks
+  * the interrupt.
+  *
+  * @param netif the lwip network interface structure for this ethernetif
+  */
+static void ETHInputPoll(struct netif *netif)
+{
+  struct pbuf *p;
+  int frames;
+  int idle = 0;
+
+  for( ;; )
+  {
+    for (frames = 0; frames < ETH_RX_POLL_BUDGET; frames++)
+    {
+      p = low_level_input( netif );
+      if (p == NULL)
+        break;
+      if (netif->input( p, netif) != ERR_OK )
+      {
+        pbuf_free(p);
+      }
+    }
+    if (frames == ETH_RX_POLL_BUDGET)
+      idle = 0;
+    else
+    {
+      /* The ring is empty, the poll that emptied it counts as the first idle one */
+      idle = (frames > 0) ? 1 : idle + 1;
+      if (idle >= ETH_RX_POLL_IDLE)
+        break;
+    }
+    /* Budget used up or waiting for more frames, let the lower priority tasks run */
+    OSTimeDly(1);
+  }
+
+  /* A frame that came in since the last poll has left its flag set, the interrupt fires at once */
+  __HAL_ETH_DMA_ENABLE_IT(&EthHandle, ETH_DMA_IT_R);
+}
+#endif /* ETH_RX_POLL */
+
 /**
   * @brief This function is the ethernetif_input task, it is processed when a packet 
   * is ready to be read from the interface. It uses the function low_level_input() 
@@ -547,7 +666,9 @@ static struct pbuf * low_level_input(struct netif *netif)
   */
 static void ETHInputTask( void * argument )
 {
+#if !ETH_RX_POLL
   struct pbuf *p;
+#endif
   struct netif *netif = (struct netif *) argument;
   
   INT8U pendErr = OS_ERR_NONE;
@@ -556,11 +677,18 @@ static void ETHInputTask( void * argument )
 
 
     OSSemPend(newEthPacketSem, 1000, &pendErr);
+#if ETH_ZERO_COPY_TX
+    /* Also on the timeout, a sent frame must not stay referenced on an idle link */
+    ethernetif_tx_reclaim();
+#endif /* ETH_ZERO_COPY_TX */
     if(pendErr == OS_ERR_TIMEOUT) {
     	low_level_check_link_state(&EthHandle, netif);
     }
     else if(pendErr == OS_ERR_NONE)
     {
+#if ETH_RX_POLL
+      ETHInputPoll(netif);
+#else
       do
       {
         p = low_level_input( netif );
@@ -572,6 +700,7 @@ static void ETHInputTask( void * argument )
           }
         }
       }while(p!=NULL);
+#endif /* ETH_RX_POLL */
     }
   }
 }
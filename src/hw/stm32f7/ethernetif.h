@@ -6,7 +6,74 @@
 #include "lwip/netif.h"
 #include "ucos_ii.h"
 
+/* ETH_ZERO_COPY_RX==1: a received frame is handed up in the DMA buffer of its descriptor,
+ * wrapped in a pbuf_custom, and one of ETH_RX_SPARE_BUFNB spare buffers takes its place.
+ * The buffer becomes a spare again when the pbuf is freed. Frames over several descriptors
+ * and frames arriving while all spares are held by the stack are copied as before.
+ * ETH_RX_BUF_SIZE has to be a multiple of the cache line (1536 instead of the HAL's 1524).
+ */
+#ifndef ETH_ZERO_COPY_RX
+#define ETH_ZERO_COPY_RX			0
+#endif
+#ifndef ETH_RX_SPARE_BUFNB
+#define ETH_RX_SPARE_BUFNB			4
+#endif
+
+/* ETH_ZERO_COPY_TX==1: scatter-gather transmit, the TX descriptors point into the pbufs of a frame
+ * (PBUF_REF and PBUF_ROM included) and the frame is referenced until the DMA has sent it. Parts shorter
+ * than ETH_TX_SG_MIN_LEN or not aligned to ETH_TX_SG_ALIGN are copied into the descriptor's Tx_Buff,
+ * a copy is cheaper than a descriptor for the headers. A frame with more parts than free descriptors
+ * is copied as a whole. With SYS_ARCH_PBUF_FREE_DEFER the frames are released from the TX complete
+ * interrupt, otherwise the interrupt wakes the driver's task (ETHInputTask, the GI ethernet task)
+ * which releases them. A frame referenced by the driver is not retransmitted by TCP.
+ */
+#ifndef ETH_ZERO_COPY_TX
+#define ETH_ZERO_COPY_TX			0
+#endif
+#ifndef ETH_TX_SG_MIN_LEN
+#define ETH_TX_SG_MIN_LEN			128
+#endif
+#ifndef ETH_TX_SG_ALIGN
+#define ETH_TX_SG_ALIGN				4
+#endif
+
+/* ETH_RX_POLL==1: the RX interrupt only starts a polling phase of ETHInputTask. The interrupt is
+ * masked when it fires, the task takes up to ETH_RX_POLL_BUDGET frames and then sleeps one tick so
+ * lower priority tasks (the tcpip_thread) get the cpu. The interrupt is unmasked when the ring has been
+ * found empty ETH_RX_POLL_IDLE times in a row (one tick apart, 1 unmasks as soon as it is empty). Frames arriving while the interrupt is masked
+ * stay in the descriptors, so ETH_RXBUFNB has to cover a tick at the expected rate.
+ * ETH_RX_COALESCE_WDT!=0: the DMA does not interrupt per frame but when its receive watchdog expires,
+ * ETH_RX_COALESCE_WDT * 256 HCLK cycles after the first frame without interrupt (1..255).
+ */
+#ifndef ETH_RX_POLL
+#define ETH_RX_POLL					0
+#endif
+#ifndef ETH_RX_POLL_BUDGET
+#define ETH_RX_POLL_BUDGET			32
+#endif
+#ifndef ETH_RX_POLL_IDLE
+#define ETH_RX_POLL_IDLE			1
+#endif
+#ifndef ETH_RX_COALESCE_WDT
+#define ETH_RX_COALESCE_WDT			0
+#endif
+
 /* Exported types ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 err_t ethernetif_init(struct netif *netif);
+struct pbuf * low_level_input(struct netif *netif);
+err_t low_level_output(struct netif *netif, struct pbuf *p);
+#if ETH_ZERO_COPY_RX
+void ethernetif_rx_init(void);
+struct pbuf * ethernetif_rx_take(void);
+#endif /* ETH_ZERO_COPY_RX */
+#if ETH_ZERO_COPY_TX
+void ethernetif_tx_init(void);
+err_t ethernetif_tx_send(struct pbuf *p);
+void ethernetif_tx_reclaim(void);
+int ethernetif_tx_complete(void);
+#endif /* ETH_ZERO_COPY_TX */
+#if LWIP_CHECKSUM_RX_OFFLOAD
+void ethernetif_rx_checksum(struct pbuf *p);
+#endif /* LWIP_CHECKSUM_RX_OFFLOAD */
 #endif
@@ -0,0 +1,97 @@
+/*
+ * ethernetif_cache.c
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include "ethernetif_cache.h"
+
+/*
+ * Runs op over all cache lines of [addr, addr + length)
+ */
+static void _lines(void (*op)(uint32_t *addr, int32_t dsize), uintptr_t addr, uint32_t length){
+	uintptr_t start = addr & ~(uintptr_t)(ETH_CACHE_LINE_SIZE - 1);
+	uintptr_t end = (addr + length + ETH_CACHE_LINE_SIZE - 1) & ~(uintptr_t)(ETH_CACHE_LINE_SIZE - 1);
+
+	if (length > 0)
+		op((uint32_t*)start, (int32_t)(end - start));
+}
+
+/**
+ * Makes the frame taken by HAL_ETH_GetReceivedFrame_IT visible to the cpu, length bytes
+ * spread over segCount descriptors starting at first, ETH_RX_BUF_SIZE bytes per descriptor.
+ */
+void ethernetif_cache_rx(const __IO ETH_DMADescTypeDef *first, uint32_t segCount, uint32_t length){
+#if !ETH_DMA_NONCACHEABLE
+	const __IO ETH_DMADescTypeDef *desc = first;
+	uint32_t n;
+
+	while (segCount-- > 0 && length > 0){
+		n = length < ETH_RX_BUF_SIZE ? length : ETH_RX_BUF_SIZE;
+		_lines(SCB_CleanInvalidateDCache_by_Addr, desc->Buffer1Addr, n);
+		length -= n;
+		desc = (const __IO ETH_DMADescTypeDef*)(uintptr_t)desc->Buffer2NextDescAddr;
+	}
+#endif
+}
+
+/**
+ * Writes a frame of length bytes back to memory before it is given to the DMA,
+ * ETH_TX_BUF_SIZE bytes per descriptor starting at first.
+ */
+void ethernetif_cache_tx(const __IO ETH_DMADescTypeDef *first, uint32_t length){
+#if !ETH_DMA_NONCACHEABLE
+	const __IO ETH_DMADescTypeDef *desc = first;
+	uint32_t n;
+
+	while (length > 0){
+		n = length < ETH_TX_BUF_SIZE ? length : ETH_TX_BUF_SIZE;
+		_lines(SCB_CleanDCache_by_Addr, desc->Buffer1Addr, n);
+		length -= n;
+		desc = (const __IO ETH_DMADescTypeDef*)(uintptr_t)desc->Buffer2NextDescAddr;
+	}
+#endif
+}
+
+/**
+ * Cleans and invalidates a buffer that is about to be given to the RX DMA,
+ * so no line written by the cpu is evicted over received data.
+ */
+void ethernetif_cache_invalidate(void *addr, uint32_t length){
+#if !ETH_DMA_NONCACHEABLE
+	_lines(SCB_CleanInvalidateDCache_by_Addr, (uintptr_t)addr, length);
+#endif
+}
+
+/**
+ * Writes memory outside of the ETH buffers back before the DMA reads it, e.g. the pbufs
+ * of the scatter-gather TX. Done in both modes, the MPU region covers the ETH buffers only.
+ */
+void ethernetif_cache_clean(const void *addr, uint32_t length){
+	_lines(SCB_CleanDCache_by_Addr, (uintptr_t)addr, length);
+}
+
+#if ETH_DMA_NONCACHEABLE
+/**
+ * Maps the ETH buffers as shareable normal memory without caching (TEX=1, C=0, B=0),
+ * call it before the data cache is enabled. The other regions are left as they are.
+ */
+void ethernetif_mpu_config(void){
+	MPU_Region_InitTypeDef region;
+
+	HAL_MPU_Disable();
+	region.Enable = MPU_REGION_ENABLE;
+	region.Number = ETH_MPU_REGION_NUMBER;
+	region.BaseAddress = ETH_MPU_REGION_BASE;
+	region.Size = ETH_MPU_REGION_SIZE;
+	region.SubRegionDisable = 0x00;
+	region.TypeExtField = MPU_TEX_LEVEL1;
+	region.AccessPermission = MPU_REGION_FULL_ACCESS;
+	region.DisableExec = MPU_INSTRUCTION_ACCESS_DISABLE;
+	region.IsShareable = MPU_ACCESS_SHAREABLE;
+	region.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
+	region.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+	HAL_MPU_ConfigRegion(&region);
+	HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+}
+#endif /* ETH_DMA_NONCACHEABLE */
@@ -0,0 +1,50 @@
+/*
+ * ethernetif_cache.h
+ *
+ *  Created on: 17.10.2026
+ */
+
+#ifndef ETHERNETIF_CACHE_H_
+#define ETHERNETIF_CACHE_H_
+
+#include "stm32f7xx_hal.h"
+
+/* Cache maintenance of the ETH DMA buffers
+ *
+ * ETH_DMA_NONCACHEABLE==0: only the cache lines of the buffers a frame occupies are
+ * maintained, RX lines are cleaned and invalidated before the frame is read, TX lines
+ * are cleaned after the frame has been written. Rx_Buff and Tx_Buff should start on a
+ * cache line and ETH_RX_BUF_SIZE/ETH_TX_BUF_SIZE be multiples of it, otherwise the
+ * edge lines are shared with the neighbouring buffer. ETH_ZERO_COPY_RX requires it for
+ * ETH_RX_BUF_SIZE (the HAL default of 1524 is not, use 1536), Tx_Buff has to be moved
+ * behind the larger Rx_Buff where it is placed at a fixed address (__CC_ARM, __ICCARM__).
+ * ETH_DMA_NONCACHEABLE==1: the buffers are in a region the MPU maps as normal
+ * non-cacheable memory (ethernetif_mpu_config), no maintenance is done at all.
+ */
+#ifndef ETH_DMA_NONCACHEABLE
+#define ETH_DMA_NONCACHEABLE		0
+#endif
+#ifndef ETH_CACHE_LINE_SIZE
+#define ETH_CACHE_LINE_SIZE			32
+#endif
+/* Region covering Rx_Buff and Tx_Buff (SRAM2 in the ST layout), it has to grow if the
+ * zero-copy spares of ethernetif_rx.c are linked behind them */
+#ifndef ETH_MPU_REGION_NUMBER
+#define ETH_MPU_REGION_NUMBER		MPU_REGION_NUMBER1
+#endif
+#ifndef ETH_MPU_REGION_BASE
+#define ETH_MPU_REGION_BASE			0x2004C000
+#endif
+#ifndef ETH_MPU_REGION_SIZE
+#define ETH_MPU_REGION_SIZE			MPU_REGION_SIZE_16KB
+#endif
+
+void ethernetif_cache_rx(const __IO ETH_DMADescTypeDef *first, uint32_t segCount, uint32_t length);
+void ethernetif_cache_tx(const __IO ETH_DMADescTypeDef *first, uint32_t length);
+void ethernetif_cache_invalidate(void *addr, uint32_t length);
+void ethernetif_cache_clean(const void *addr, uint32_t length);
+#if ETH_DMA_NONCACHEABLE
+void ethernetif_mpu_config(void);
+#endif
+
+#endif /* ETHERNETIF_CACHE_H_ */
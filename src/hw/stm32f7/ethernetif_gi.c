@@ -50,6 +50,7 @@
 #include "lwip/opt.h"
 #include "netif/etharp.h"
 #include "ethernetif.h"
+#include "ethernetif_cache.h"
 #include <string.h>
 
 #include "lwip/timeouts.h"
@@ -186,7 +187,11 @@ void HAL_ETH_RxCpltCallback(ETH_HandleTypeDef *heth)
 
 void HAL_ETH_TxCpltCallback(ETH_HandleTypeDef *heth)
 {
-
+#if ETH_ZERO_COPY_TX
+	/* The GI ethernet task releases the sent frames in low_level_input */
+	if (ethernetif_tx_complete())
+		ethDownlinkInputFunction(NULL,NULL);
+#endif /* ETH_ZERO_COPY_TX */
 }
 
 /*******************************************************************************
@@ -223,9 +228,15 @@ static void low_level_init(struct netif *netif)
   
   /* Initialize Tx Descriptors list: Chain Mode */
   HAL_ETH_DMATxDescListInit(&EthHandle, DMATxDscrTab, &Tx_Buff[0][0], ETH_TXBUFNB);
+#if ETH_ZERO_COPY_TX
+  ethernetif_tx_init();
+#endif /* ETH_ZERO_COPY_TX */
      
   /* Initialize Rx Descriptors list: Chain Mode  */
   HAL_ETH_DMARxDescListInit(&EthHandle, DMARxDscrTab, &Rx_Buff[0][0], ETH_RXBUFNB);
+#if ETH_ZERO_COPY_RX
+  ethernetif_rx_init();
+#endif /* ETH_ZERO_COPY_RX */
   
   /* set netif MAC hardware address length */
   netif->hwaddr_len = ETHARP_HWADDR_LEN;
@@ -244,7 +255,13 @@ static void low_level_init(struct netif *netif)
   /* Accept broadcast address and ARP traffic */
   netif->flags |= NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
 
+  /* The MAC inserts the IPv4 header and TCP checksums (ETH_CHECKSUM_BY_HARDWARE). UDP and ICMP
+   * are still generated in software, the MAC does not insert them into fragmented datagrams. */
+  NETIF_SET_CHECKSUM_CTRL(netif, NETIF_CHECKSUM_ENABLE_ALL & ~(NETIF_CHECKSUM_GEN_IP | NETIF_CHECKSUM_GEN_TCP));
+
   GI_Init();
+  GI_STATS_INIT();
+  GI_Packet_Init();
   GI_Ethernet_Init(netif);
   GI_IPv4_Init(netif);
 
@@ -253,6 +270,28 @@ static void low_level_init(struct netif *netif)
 }
 
 
+#if NETIF_DO_TIMESTAMPING == 0
+/**
+  * @brief Takes the software TX timestamp for UDP frames from or to port 2468
+  *
+  * @param buffer the start of the frame
+  * @param framelength the bytes of the frame in buffer
+  */
+static void low_level_tx_timestamp(uint8_t *buffer, uint32_t framelength)
+{
+    if(framelength > 42){	/* Min UDP Size */
+    	if(((buffer[12] << 8) | buffer[13]) == 0x0800){	/* IP */
+    		if(buffer[23] == 17){ /* UDP */
+    			if(((buffer[34] << 8) | buffer[35]) == 2468 || ((buffer[36] << 8) | buffer[37]) == 2468){
+    				triggerTxTimestamp = 1;
+    				txTimestamp = TB_GetTimeLong();
+    			}
+    		}
+    	}
+    }
+}
+#endif
+
 /**
   * @brief This function should do the actual transmission of the packet. The packet is
   * contained in the pbuf that is passed to the function. This pbuf
@@ -268,6 +307,17 @@ static void low_level_init(struct netif *netif)
   *       to become available since the stack doesn't retry to send a packet
   *       dropped because of memory failure (except for the TCP timers).
   */
+#if ETH_ZERO_COPY_TX
+err_t low_level_output(struct netif *netif, struct pbuf *p)
+{
+#if NETIF_DO_TIMESTAMPING == 0
+  /* The headers are in the first pbuf */
+  low_level_tx_timestamp((uint8_t *)p->payload, p->len);
+#endif
+  /* Point the transmit descriptors into the pbufs, the frame is referenced until it is sent */
+  return ethernetif_tx_send(p);
+}
+#else
 err_t low_level_output(struct netif *netif, struct pbuf *p)
 {
   err_t errval;
@@ -327,20 +377,11 @@ err_t low_level_output(struct netif *netif, struct pbuf *p)
   }
 
 #if NETIF_DO_TIMESTAMPING == 0
-    if(framelength > 42){	/* Min UDP Size */
-    	if(((buffer[12] << 8) | buffer[13]) == 0x0800){	/* IP */
-    		if(buffer[23] == 17){ /* UDP */
-    			if(((buffer[34] << 8) | buffer[35]) == 2468 || ((buffer[36] << 8) | buffer[37]) == 2468){
-    				triggerTxTimestamp = 1;
-    				txTimestamp = TB_GetTimeLong();
-    			}
-    		}
-    	}
-    }
+  low_level_tx_timestamp(buffer, framelength);
 #endif
 
-  /* Clean and Invalidate data cache */
-  SCB_CleanInvalidateDCache();  
+  /* Clean the data cache lines written above */
+  ethernetif_cache_tx(EthHandle.TxDesc, framelength);
   /* Prepare transmit descriptors to give to DMA */ 
   HAL_ETH_TransmitFrame(&EthHandle, framelength);
   
@@ -359,6 +400,7 @@ error:
   }
   return errval;
 }
+#endif /* ETH_ZERO_COPY_TX */
 
 /**
   * @brief Should allocate a pbuf and transfer the bytes of the incoming
@@ -378,7 +420,12 @@ struct pbuf * low_level_input(struct netif *netif)
   uint32_t payloadoffset = 0;
   uint32_t byteslefttocopy = 0;
   uint32_t i=0;
+  uint8_t zeroCopy = 0;
   
+#if ETH_ZERO_COPY_TX
+  ethernetif_tx_reclaim();
+#endif /* ETH_ZERO_COPY_TX */
+
   /* get received frame */
   if(HAL_ETH_GetReceivedFrame_IT(&EthHandle) != HAL_OK)
     return NULL;
@@ -389,14 +436,22 @@ struct pbuf * low_level_input(struct netif *netif)
   
   if (len > 0)
   {
-    /* We allocate a pbuf chain of pbufs from the Lwip buffer pool */
-    p = pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
+    /* Clean and Invalidate the data cache lines of the frame */
+    ethernetif_cache_rx(EthHandle.RxFrameInfos.FSRxDesc, EthHandle.RxFrameInfos.SegCount, len);
+#if ETH_ZERO_COPY_RX
+    /* Hand the DMA buffer itself up if possible, copy otherwise */
+    p = ethernetif_rx_take();
+    zeroCopy = (p != NULL);
+#endif /* ETH_ZERO_COPY_RX */
+    if (!zeroCopy)
+    {
+      /* We allocate a pbuf chain of pbufs from the Lwip buffer pool, with
+       * headroom for ETH_SEND_DATA if a reply reuses it (icmp echo) */
+      p = pbuf_alloc(PBUF_RAW_TX, len, PBUF_POOL);
+    }
   }
   
-  /* Clean and Invalidate data cache */
-  SCB_CleanInvalidateDCache();
-  
-  if (p != NULL)
+  if (p != NULL && !zeroCopy)
   {
     dmarxdesc = EthHandle.RxFrameInfos.FSRxDesc;
     bufferoffset = 0;
@@ -440,6 +495,12 @@ struct pbuf * low_level_input(struct netif *netif)
     }
 #endif
     
+#if LWIP_CHECKSUM_RX_OFFLOAD
+  /* Pass the checksum check of the MAC on, read before the descriptors are released */
+  if (p != NULL)
+    ethernetif_rx_checksum(p);
+#endif /* LWIP_CHECKSUM_RX_OFFLOAD */
+
   /* Release descriptors to DMA */
   /* Point to first descriptor */
   dmarxdesc = EthHandle.RxFrameInfos.FSRxDesc;
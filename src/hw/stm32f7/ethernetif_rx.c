@@ -0,0 +1,144 @@
+/*
+ * ethernetif_rx.c
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include "stm32f7xx_hal.h"
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/memp.h"
+#include "lwip/sys.h"
+#include "ethernetif.h"
+#include "ethernetif_cache.h"
+
+extern ETH_HandleTypeDef EthHandle;
+
+#if LWIP_CHECKSUM_RX_OFFLOAD
+/**
+ * Marks p with the result of the checksum check the MAC did on the frame taken by
+ * HAL_ETH_GetReceivedFrame_IT, from the extended status of the enhanced descriptors.
+ * Only IPv4 with a TCP, UDP or ICMP payload is marked, everything else (fragments,
+ * IPv6, other protocols) is left to the software checks.
+ */
+void ethernetif_rx_checksum(struct pbuf *p){
+	__IO ETH_DMADescTypeDef *desc = EthHandle.RxFrameInfos.LSRxDesc;
+	uint32_t ext, type;
+
+	/* Type frame with extended status available */
+	if ((desc->Status & (ETH_DMARXDESC_FT | ETH_DMARXDESC_MAMPCE)) != (ETH_DMARXDESC_FT | ETH_DMARXDESC_MAMPCE))
+		return;
+	ext = desc->ExtendedStatus;
+	if ((ext & ETH_DMAPTPRXDESC_IPV4PR) == 0 || (ext & ETH_DMAPTPRXDESC_IPCB) != 0)
+		return;
+	type = ext & ETH_DMAPTPRXDESC_IPPT;
+	if ((ext & (ETH_DMAPTPRXDESC_IPHE | ETH_DMAPTPRXDESC_IPPE)) != 0)
+		p->flags |= PBUF_FLAG_CSUM_BAD;
+	else if (type == ETH_DMAPTPRXDESC_IPPT_UDP || type == ETH_DMAPTPRXDESC_IPPT_TCP || type == ETH_DMAPTPRXDESC_IPPT_ICMP)
+		p->flags |= PBUF_FLAG_CSUM_OK;
+}
+#endif /* LWIP_CHECKSUM_RX_OFFLOAD */
+
+#if ETH_ZERO_COPY_RX
+
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#error "ETH_ZERO_COPY_RX needs LWIP_SUPPORT_CUSTOM_PBUF"
+#endif
+/* The stack writes into a buffer it holds (e.g. ip4_reass over the IP header), a line shared with
+ * the neighbouring buffer would be evicted over data the DMA wrote there */
+#if !ETH_DMA_NONCACHEABLE && (ETH_RX_BUF_SIZE % ETH_CACHE_LINE_SIZE) != 0
+#error "ETH_ZERO_COPY_RX needs ETH_RX_BUF_SIZE to be a multiple of ETH_CACHE_LINE_SIZE, e.g. 1536"
+#endif
+
+typedef struct {
+	struct pbuf_custom p;
+	uint8_t *buffer;			/* DMA buffer the payload points into */
+} ETH_RX_PBUF;
+
+/* Every buffer may be held by the stack, ETH_RXBUFNB of them in descriptors */
+LWIP_MEMPOOL_DECLARE(eth_rx_pbuf_pool, ETH_RXBUFNB + ETH_RX_SPARE_BUFNB, sizeof(ETH_RX_PBUF), "Zero-copy RX PBUF pool");
+
+/* Spare buffers, in the RX buffer section and starting on a cache line */
+#if defined ( __GNUC__ )
+static uint8_t _rxSpareBuff[ETH_RX_SPARE_BUFNB][ETH_RX_BUF_SIZE] __attribute__((section(".RxarraySection"))) __ALIGNED(ETH_CACHE_LINE_SIZE);
+#else
+static __ALIGNED(ETH_CACHE_LINE_SIZE) uint8_t _rxSpareBuff[ETH_RX_SPARE_BUFNB][ETH_RX_BUF_SIZE];
+#endif
+
+/* Buffers that are neither in a descriptor nor held by the stack. The stack holds
+ * at most ETH_RX_SPARE_BUFNB buffers at a time, so the list never overflows. */
+static uint8_t *_rxSpare[ETH_RX_SPARE_BUFNB];
+static int _rxSpareCount;
+
+/*
+ * custom_free_function of the pbufs, may be called from any task
+ */
+static void _rxFree(struct pbuf *p){
+	ETH_RX_PBUF *rx = (ETH_RX_PBUF*)p;
+	SYS_ARCH_DECL_PROTECT(lev);
+
+	SYS_ARCH_PROTECT(lev);
+	_rxSpare[_rxSpareCount++] = rx->buffer;
+	SYS_ARCH_UNPROTECT(lev);
+	LWIP_MEMPOOL_FREE(eth_rx_pbuf_pool, rx);
+}
+
+static uint8_t *_rxSpareGet(void){
+	uint8_t *buffer = NULL;
+	SYS_ARCH_DECL_PROTECT(lev);
+
+	SYS_ARCH_PROTECT(lev);
+	if (_rxSpareCount > 0)
+		buffer = _rxSpare[--_rxSpareCount];
+	SYS_ARCH_UNPROTECT(lev);
+	return buffer;
+}
+
+/**
+ * Init Function, called after the RX descriptors have been set up
+ */
+void ethernetif_rx_init(void){
+	int i;
+
+	LWIP_MEMPOOL_INIT(eth_rx_pbuf_pool);
+	for (i = 0; i < ETH_RX_SPARE_BUFNB; i++)
+		_rxSpare[i] = _rxSpareBuff[i];
+	_rxSpareCount = ETH_RX_SPARE_BUFNB;
+}
+
+/**
+ * Wraps the frame taken by HAL_ETH_GetReceivedFrame_IT in a pbuf and puts a spare buffer
+ * into its descriptor, the descriptor still has to be given back to the DMA by the caller.
+ * Returns NULL if the frame has to be copied: it is spread over several descriptors or
+ * there is no spare buffer or pbuf left.
+ */
+struct pbuf * ethernetif_rx_take(void){
+	__IO ETH_DMADescTypeDef *dmarxdesc = EthHandle.RxFrameInfos.FSRxDesc;
+	uint16_t len = EthHandle.RxFrameInfos.length;
+	ETH_RX_PBUF *rx;
+	uint8_t *spare;
+	struct pbuf *p;
+
+	if (EthHandle.RxFrameInfos.SegCount != 1 || len == 0 || len > ETH_RX_BUF_SIZE)
+		return NULL;
+	rx = (ETH_RX_PBUF*)LWIP_MEMPOOL_ALLOC(eth_rx_pbuf_pool);
+	if (rx == NULL)
+		return NULL;
+	spare = _rxSpareGet();
+	if (spare == NULL){
+		LWIP_MEMPOOL_FREE(eth_rx_pbuf_pool, rx);
+		return NULL;
+	}
+
+	rx->buffer = (uint8_t*)dmarxdesc->Buffer1Addr;
+	rx->p.custom_free_function = _rxFree;
+	p = pbuf_alloced_custom(PBUF_RAW, len, PBUF_REF, &rx->p, rx->buffer, ETH_RX_BUF_SIZE);
+
+	/* The stack may have written into the spare (e.g. while building a reply in place),
+	 * these lines must not be evicted over the next frame */
+	ethernetif_cache_invalidate(spare, ETH_RX_BUF_SIZE);
+	dmarxdesc->Buffer1Addr = (uint32_t)spare;
+	return p;
+}
+
+#endif /* ETH_ZERO_COPY_RX */
@@ -0,0 +1,211 @@
+/*
+ * ethernetif_tx.c
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include "stm32f7xx_hal.h"
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/sys.h"
+#include "ethernetif.h"
+#include "ethernetif_cache.h"
+#include <string.h>
+
+#if ETH_ZERO_COPY_TX
+
+/* The ring in chain order, the copy buffer HAL_ETH_DMATxDescListInit gave every descriptor
+ * and the frame a descriptor completes (set on the last descriptor of a frame only) */
+static ETH_DMADescTypeDef *_txDesc[ETH_TXBUFNB];
+static uint8_t *_txCopyBuff[ETH_TXBUFNB];
+static struct pbuf *_txPbuf[ETH_TXBUFNB];
+
+static int _txHead;				// next descriptor to fill, EthHandle.TxDesc
+static int _txTail;				// oldest descriptor not reclaimed
+static int _txUsed;				// descriptors from tail to head
+
+extern ETH_HandleTypeDef EthHandle;
+
+/*
+ * Takes the descriptor at tail back if the DMA is done with it, *p is the frame it completes
+ * or NULL. Returns 0 if there is nothing to take back.
+ */
+static int _txReclaimOne(struct pbuf **p){
+	int ret = 0;
+	SYS_ARCH_DECL_PROTECT(lev);
+
+	SYS_ARCH_PROTECT(lev);
+	if (_txUsed > 0 && (_txDesc[_txTail]->Status & ETH_DMATXDESC_OWN) == (uint32_t)RESET){
+		*p = _txPbuf[_txTail];
+		_txPbuf[_txTail] = NULL;
+		_txTail = (_txTail + 1) % ETH_TXBUFNB;
+		_txUsed--;
+		ret = 1;
+	}
+	SYS_ARCH_UNPROTECT(lev);
+	return ret;
+}
+
+/**
+ * Frees the frames that have been sent, task context. Called by ethernetif_tx_send and by the
+ * task ethernetif_tx_complete wakes, a frame still referenced here keeps TCP from retransmitting it.
+ */
+void ethernetif_tx_reclaim(void){
+	struct pbuf *p;
+
+	while (_txReclaimOne(&p)){
+		if (p != NULL)
+			pbuf_free(p);
+	}
+}
+
+/**
+ * Init Function, called after the TX descriptors have been set up
+ */
+void ethernetif_tx_init(void){
+	ETH_DMADescTypeDef *desc = EthHandle.TxDesc;
+	int i;
+
+	for (i = 0; i < ETH_TXBUFNB; i++){
+		_txDesc[i] = desc;
+		_txCopyBuff[i] = (uint8_t*)desc->Buffer1Addr;
+		_txPbuf[i] = NULL;
+		desc = (ETH_DMADescTypeDef*)desc->Buffer2NextDescAddr;
+	}
+	_txHead = _txTail = _txUsed = 0;
+	/* HAL_ETH_Init only enables the RX interrupt */
+	__HAL_ETH_DMA_ENABLE_IT(&EthHandle, ETH_DMA_IT_T);
+}
+
+/*
+ * Fills the free descriptors from head on with the frame p. With sg set, parts of at least
+ * ETH_TX_SG_MIN_LEN bytes on an ETH_TX_SG_ALIGN boundary get a descriptor of their own that points
+ * into the pbuf, *refs is set then. All other parts are copied into the copy buffer of a descriptor,
+ * successive ones into the same as long as they fit. Returns the number of descriptors used, -1 if
+ * there are not enough free ones, *last is the last descriptor of the frame.
+ */
+static int _txFill(struct pbuf *p, int sg, int *last, int *refs){
+	struct pbuf *q;
+	int idx = _txHead, count = 0;
+	uint8_t *copy = NULL;		// copy buffer of the current descriptor, NULL if it points into a pbuf
+	uint32_t copyLen = 0;
+	uint32_t off, n;
+
+	*refs = 0;
+	for (q = p; q != NULL; q = q->next){
+		if (q->len == 0)
+			continue;
+		if (sg && ((uintptr_t)q->payload & (ETH_TX_SG_ALIGN - 1)) == 0 && q->len >= ETH_TX_SG_MIN_LEN
+				&& q->len <= ETH_DMATXDESC_TBS1){
+			if (_txUsed + count >= ETH_TXBUFNB)
+				return -1;
+			idx = (_txHead + count++) % ETH_TXBUFNB;
+			_txDesc[idx]->Buffer1Addr = (uint32_t)q->payload;
+			_txDesc[idx]->ControlBufferSize = q->len & ETH_DMATXDESC_TBS1;
+			ethernetif_cache_clean(q->payload, q->len);
+			copy = NULL;
+			*refs = 1;
+			continue;
+		}
+		for (off = 0; off < q->len; off += n){
+			if (copy == NULL || copyLen == ETH_TX_BUF_SIZE){
+				if (_txUsed + count >= ETH_TXBUFNB)
+					return -1;
+				idx = (_txHead + count++) % ETH_TXBUFNB;
+				copy = _txCopyBuff[idx];
+				copyLen = 0;
+				_txDesc[idx]->Buffer1Addr = (uint32_t)copy;
+			}
+			n = LWIP_MIN(q->len - off, ETH_TX_BUF_SIZE - copyLen);
+			memcpy(copy + copyLen, (uint8_t*)q->payload + off, n);
+			ethernetif_cache_clean(copy + copyLen, n);
+			copyLen += n;
+			_txDesc[idx]->ControlBufferSize = copyLen & ETH_DMATXDESC_TBS1;
+		}
+	}
+	*last = idx;
+	return count;
+}
+
+/**
+ * Gives the frame p to the DMA, scatter-gather as far as the free descriptors allow (see _txFill).
+ * A frame with more parts than free descriptors is copied into the copy buffers as a whole, as the
+ * copying low_level_output does, so a chain longer than the ring is sent as well.
+ * p is referenced until the DMA has sent it if a descriptor points into it.
+ * Returns ERR_USE if not even the copy fits, nothing is given to the DMA then.
+ */
+err_t ethernetif_tx_send(struct pbuf *p){
+	int first = _txHead, last, count, refs, i;
+	SYS_ARCH_DECL_PROTECT(lev);
+
+	ethernetif_tx_reclaim();
+
+	count = _txFill(p, 1, &last, &refs);
+	if (count < 0)
+		count = _txFill(p, 0, &last, &refs);
+	if (count < 0)
+		return ERR_USE;
+	if (count == 0)
+		return ERR_OK;
+
+	if (refs)
+		pbuf_ref(p);
+	_txPbuf[last] = refs ? p : NULL;
+
+	/* Hand the descriptors over back to front, the DMA may start as soon as the first is its own */
+	for (i = count - 1; i >= 0; i--){
+		ETH_DMADescTypeDef *desc = _txDesc[(first + i) % ETH_TXBUFNB];
+		uint32_t status = desc->Status & ~(ETH_DMATXDESC_FS | ETH_DMATXDESC_LS | ETH_DMATXDESC_IC);
+
+		if (i == count - 1)
+			status |= ETH_DMATXDESC_LS | ETH_DMATXDESC_IC;
+		if (i > 0){
+			desc->Status = status | ETH_DMATXDESC_OWN;
+			continue;
+		}
+		/* buffers and the other descriptors are written before the DMA sees the frame */
+		__DSB();
+		/* counted together with the first OWN bit, a reclaim in between would take it back unsent */
+		SYS_ARCH_PROTECT(lev);
+		_txUsed += count;
+		desc->Status = status | ETH_DMATXDESC_FS | ETH_DMATXDESC_OWN;
+		SYS_ARCH_UNPROTECT(lev);
+	}
+	_txHead = (first + count) % ETH_TXBUFNB;
+	EthHandle.TxDesc = _txDesc[_txHead];
+
+	/* When Tx Buffer unavailable flag is set: clear it and resume transmission */
+	if ((EthHandle.Instance->DMASR & ETH_DMASR_TBUS) != (uint32_t)RESET)
+	{
+		EthHandle.Instance->DMASR = ETH_DMASR_TBUS;
+		EthHandle.Instance->DMATPDR = 0;
+	}
+	/* Same for a transmit underflow */
+	if ((EthHandle.Instance->DMASR & ETH_DMASR_TUS) != (uint32_t)RESET)
+	{
+		EthHandle.Instance->DMASR = ETH_DMASR_TUS;
+		EthHandle.Instance->DMATPDR = 0;
+	}
+	return ERR_OK;
+}
+
+/**
+ * Called by HAL_ETH_TxCpltCallback. With SYS_ARCH_PBUF_FREE_DEFER the sent frames are given to
+ * sys_arch_pbuf_free_fromisr and 0 is returned. Otherwise returns 1 if there are sent frames,
+ * the driver then wakes its task to call ethernetif_tx_reclaim.
+ */
+int ethernetif_tx_complete(void){
+#if SYS_ARCH_PBUF_FREE_DEFER
+	struct pbuf *p;
+
+	while (_txReclaimOne(&p)){
+		if (p != NULL)
+			sys_arch_pbuf_free_fromisr(p);
+	}
+	return 0;
+#else
+	return _txUsed > 0 && (_txDesc[_txTail]->Status & ETH_DMATXDESC_OWN) == (uint32_t)RESET;
+#endif
+}
+
+#endif /* ETH_ZERO_COPY_TX */
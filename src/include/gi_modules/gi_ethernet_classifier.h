@@ -0,0 +1,35 @@
+/*
+ * gi_ethernet_classifier.h
+ *
+ *  Created on: 17.10.2026
+ */
+
+#ifndef SRC_MODULES_IDA_LWIP_SRC_INCLUDE_GI_MODULES_GI_ETHERNET_CLASSIFIER_H_
+#define SRC_MODULES_IDA_LWIP_SRC_INCLUDE_GI_MODULES_GI_ETHERNET_CLASSIFIER_H_
+
+#include "lwip/prot/ethernet.h"
+#include "gi_modules/gi_packet.h"
+
+/* Max. number of rules, hash buckets have to be a power of two */
+#ifndef ETH_CLASSIFIER_MAX_RULES
+#define ETH_CLASSIFIER_MAX_RULES			32
+#endif
+#ifndef ETH_CLASSIFIER_HASH_SIZE
+#define ETH_CLASSIFIER_HASH_SIZE			16
+#endif
+
+/* Wildcards for a rule, frames without VLAN tag have VLAN id 0 */
+#define ETH_CLASSIFIER_MAC_ANY				NULL
+#define ETH_CLASSIFIER_VLAN_ANY				0xFFFF
+
+/* Link id of a rule that drops the frame */
+#define ETH_CLASSIFIER_DROP					(-1)
+
+void GI_EthClassifier_Init(void);
+int GI_EthClassifier_AddRule(const struct eth_addr *dest, u16_t eth_type, u16_t vlan,
+				int linkId, GI_TRAFFIC_CLASS trafficClass);
+int GI_EthClassifier_RemoveRule(const struct eth_addr *dest, u16_t eth_type, u16_t vlan);
+int GI_EthClassifier_Lookup(const struct eth_addr *dest, u16_t eth_type, u16_t vlan,
+				GI_TRAFFIC_CLASS *trafficClass);
+
+#endif /* SRC_MODULES_IDA_LWIP_SRC_INCLUDE_GI_MODULES_GI_ETHERNET_CLASSIFIER_H_ */
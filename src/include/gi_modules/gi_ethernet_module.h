@@ -12,16 +12,39 @@
 #include "ethernetif.h"
 #include "netif/ethernet.h"
 #include "stm32f7xx_hal_conf.h"
+#include "gi_modules/gi_packet.h"
+#include "gi_modules/gi_flow.h"
 
+/* Max. number of links, the downlink and the uplinks */
+#ifndef ETH_MAX_LINKS
+#define ETH_MAX_LINKS						8
+#endif
+#define ETH_LINK_QUEUE_SIZE				20
+
+/* Max. number of frames taken from the MAC per activation of the task */
+#ifndef ETH_RX_BURST_SIZE
+#define ETH_RX_BURST_SIZE					8
+#endif
+
+/* Send metadata, kept in the pbuf headroom in front of the ethernet header
+ * (see GI_Packet_PutSendData). The stack has to reserve the difference to
+ * PBUF_LINK_HLEN with PBUF_LINK_ENCAPSULATION_HLEN. */
 typedef struct{
 	struct netif * netif;
-	struct pbuf * p;
-	const struct eth_addr * src;
-	const struct eth_addr * dst;
+	struct eth_addr src;
+	struct eth_addr dst;
 	u16_t eth_type;
+#if GI_STATS
+	u32_t enqueueTime;
+#endif /* GI_STATS */
 }ETH_SEND_DATA;
 
 
 void GI_Ethernet_Init(void *netif);
+int GI_Ethernet_AddUplink(GI_LINK_FKT outputFkt);
+int GI_Ethernet_SetUplinkFlow(int linkId, GI_FLOW *flow);
+int GI_Ethernet_SetUplinkSched(int linkId, u8_t prio, u32_t rate, u32_t burst);
+u32_t GI_Ethernet_GetUplinkDrops(int linkId);
+int ethDownlinkInputFunction(void* p_arg1, void* p_arg2);
 
 #endif /* SRC_MODULES_IDA_LWIP_SRC_INCLUDE_GI_MODULES_GI_ETHERNET_MODULE_H_ */
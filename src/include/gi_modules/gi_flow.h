@@ -0,0 +1,39 @@
+/*
+ * gi_flow.h
+ *
+ *  Created on: 17.10.2026
+ */
+
+#ifndef SRC_MODULES_IDA_LWIP_SRC_INCLUDE_GI_MODULES_GI_FLOW_H_
+#define SRC_MODULES_IDA_LWIP_SRC_INCLUDE_GI_MODULES_GI_FLOW_H_
+
+#include "gi.h"
+#include "gi_modules/gi_packet.h"
+
+/* Called on every change of the congestion state, outside the critical section */
+typedef void (*GI_FLOW_EVENT_FKT)(void *arg, u8_t congested);
+
+/**
+ * Credits of one GI queue link. The sender takes a credit for every queue entry
+ * before posting, the receiving module returns it when the entry is dequeued.
+ * Above the high watermark only critical traffic gets credits, so the queue
+ * itself never runs full for it, below the low watermark the link is free again.
+ */
+typedef struct{
+	u16_t credits;				/* free entries of the queue */
+	u16_t size;
+	u16_t highWater;			/* used entries that raise the congestion event */
+	u16_t lowWater;				/* used entries that clear it */
+	u8_t congested;
+	GI_FLOW_EVENT_FKT eventFkt;
+	void *eventArg;
+}GI_FLOW;
+
+#define GI_Flow_IsCongested(flow)		((flow)->congested)
+
+void GI_Flow_Init(GI_FLOW *flow, u16_t size, u16_t highWater, u16_t lowWater);
+void GI_Flow_SetEvent(GI_FLOW *flow, GI_FLOW_EVENT_FKT eventFkt, void *arg);
+int GI_Flow_Take(GI_FLOW *flow, GI_TRAFFIC_CLASS trafficClass);
+void GI_Flow_Return(GI_FLOW *flow);
+
+#endif /* SRC_MODULES_IDA_LWIP_SRC_INCLUDE_GI_MODULES_GI_FLOW_H_ */
@@ -11,17 +11,38 @@
 #include "gi.h"
 #include "lwip/ip.h"
 #include "lwip/ip4.h"
+#include "gi_modules/gi_packet.h"
+#include "gi_modules/gi_flow.h"
 
+/* Send metadata, kept in the pbuf headroom in front of the IP header
+ * (see GI_Packet_PutSendData) */
 typedef struct{
-	struct pbuf *p;
-	const ip4_addr_t *src;
-	const ip4_addr_t *dest;
+	struct netif *netif;
+	ip4_addr_t src;
+	ip4_addr_t dest;
 	u8_t ttl;
 	u8_t tos;
 	u8_t proto;
-	struct netif *netif;
+	u8_t hdrincl;			/* dest was LWIP_IP_HDRINCL */
+#if GI_STATS
+	u32_t enqueueTime;
+#endif /* GI_STATS */
 }IPv4_SEND_DATA;
 
+/* Link id for protocols handled by lwIP itself inside ip4_input */
+#define IPV4_LINK_LOCAL					(-1)
+
 void GI_IPv4_Init(void *netif);
+int GI_IPv4_AddUplink(GI_LINK_FKT outputFkt);
+int GI_IPv4_SetProtocolLink(u8_t proto, int linkId);
+int GI_IPv4_AddPortRule(u8_t proto, u16_t portLow, u16_t portHigh, int linkId);
+int GI_IPv4_RemovePortRule(u8_t proto, u16_t portLow, u16_t portHigh);
+GI_FLOW* GI_IPv4_GetInputFlow(int linkId);
+int GI_IPv4_EnableInline(void);
+void GI_IPv4_InputInline(GI_PACKET *pkt);
+void GI_IPv4_TxFlowEvent(void *arg, u8_t congested);
+
+err_t ip4_input_wrapper(GI_PACKET *pkt);
+err_t etharp_input_wrapper(GI_PACKET *pkt);
 
 #endif /* SRC_MODULES_IDA_LWIP_SRC_INCLUDE_GI_MODULES_GI_IPV4_MODULE_H_ */
@@ -0,0 +1,79 @@
+/*
+ * gi_packet.h
+ *
+ *  Created on: 17.10.2026
+ */
+
+#ifndef SRC_MODULES_IDA_LWIP_SRC_INCLUDE_GI_MODULES_GI_PACKET_H_
+#define SRC_MODULES_IDA_LWIP_SRC_INCLUDE_GI_MODULES_GI_PACKET_H_
+
+#include "gi.h"
+#include "lwip/pbuf.h"
+#include "lwip/netif.h"
+#include "lwip/ip.h"
+#include "gi_modules/gi_stats.h"
+
+/* Number of packet descriptors, one for every entry of the queue behind each
+ * uplink of the ethernet module (ETH_MAX_LINKS - 1 of them, the IPv4 links are
+ * as large as ETH_LINK_QUEUE_SIZE) and the burst taken from the MAC. A frame
+ * that finds the pool empty is dropped and counted in the drops of "eth mac".
+ * Expands to the ethernet module's sizes, see gi_ethernet_module.h. */
+#ifndef GI_PACKET_POOL_SIZE
+#define GI_PACKET_POOL_SIZE				((ETH_MAX_LINKS - 1)*ETH_LINK_QUEUE_SIZE + ETH_RX_BURST_SIZE)
+#endif
+
+typedef enum {
+	GI_PACKET_DISCARD = 0,
+	GI_PACKET_IPV4,
+	GI_PACKET_ARP,
+	GI_PACKET_UDP,
+	GI_PACKET_TCP,
+	GI_PACKET_ICMP,
+	GI_PACKET_IGMP,
+	GI_PACKET_IP				/* any other IP protocol */
+}GI_PACKET_TYPE;
+
+typedef enum {
+	GI_CLASS_NON_CRITICAL = 0,
+	GI_CLASS_CRITICAL
+}GI_TRAFFIC_CLASS;
+
+/**
+ * Per-packet descriptor, travels together with the pbuf through the GI_LINK
+ * queues. Every module stage fills in what it has parsed, so the router and
+ * the uplinks of the following stage never depend on module globals.
+ */
+typedef struct gi_packet{
+	struct gi_packet *next;		/* packets of one burst handed over together */
+	struct pbuf *p;
+	struct netif *netif;
+	GI_PACKET_TYPE type;
+	GI_TRAFFIC_CLASS trafficClass;
+	u16_t eth_type;				/* ethertype behind the VLAN tag, host order */
+	u16_t vlan;					/* VLAN id, 0 if untagged */
+	u8_t *frame;				/* start of the ethernet header */
+	u16_t l3_offset;			/* offset of the IP/ARP header from frame */
+	u16_t l4_offset;			/* offset of the UDP/TCP header from frame */
+	u8_t ip_proto;
+	s8_t ip_link;				/* IPv4 uplink, classified once in ip4_input, -1 if none */
+	u16_t dst_port;				/* UDP/TCP destination port, host order */
+	struct ip_globals ip_data;	/* ip_data as seen by ip4_input, restored for udp/tcp_input */
+#if GI_STATS
+	u32_t rxTime;				/* taken from the MAC */
+	u32_t enqueueTime;			/* posted to the current link, set in the head of a chain */
+#endif /* GI_STATS */
+}GI_PACKET;
+
+#define GI_PACKET_ETH_HDR(pkt)		((struct eth_hdr *)(pkt)->frame)
+#define GI_PACKET_IP_HDR(pkt)		((struct ip_hdr *)((pkt)->frame + (pkt)->l3_offset))
+
+void GI_Packet_Init(void);
+GI_PACKET* GI_Packet_Alloc(struct pbuf *p, struct netif *netif);
+void GI_Packet_Free(GI_PACKET *pkt);
+void GI_Packet_Drop(GI_PACKET *pkt);
+void GI_Packet_DropChain(GI_PACKET *pkt);
+
+int GI_Packet_PutSendData(struct pbuf *p, const void *data, u16_t len);
+void GI_Packet_GetSendData(struct pbuf *p, void *data, u16_t len);
+
+#endif /* SRC_MODULES_IDA_LWIP_SRC_INCLUDE_GI_MODULES_GI_PACKET_H_ */
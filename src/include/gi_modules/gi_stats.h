@@ -0,0 +1,82 @@
+/*
+ * gi_stats.h
+ *
+ *  Created on: 17.10.2026
+ */
+
+#ifndef SRC_MODULES_IDA_LWIP_SRC_INCLUDE_GI_MODULES_GI_STATS_H_
+#define SRC_MODULES_IDA_LWIP_SRC_INCLUDE_GI_MODULES_GI_STATS_H_
+
+#include "gi.h"
+#include "lwip/opt.h"
+
+/* Latency and occupancy statistics of the GI queue links, 0 removes it all.
+ * Usually set in lwipopts.h together with GI_STATS_TIME. */
+#ifndef GI_STATS
+#define GI_STATS							0
+#endif
+
+#if GI_STATS
+
+/* Max. number of links that can be registered */
+#ifndef GI_STATS_MAX_LINKS
+#define GI_STATS_MAX_LINKS					16
+#endif
+
+/* Histogram bins, bin 0 counts latency 0, bin n latencies in [2^(n-1), 2^n),
+ * the last bin everything above */
+#ifndef GI_STATS_HIST_BINS
+#define GI_STATS_HIST_BINS					16
+#endif
+
+/* Timestamp source, OS ticks by default. Define it to a cycle counter for
+ * sub-tick resolution, it has to be readable from any task and interrupt. */
+#ifndef GI_STATS_TIME
+#define GI_STATS_TIME()					((u32_t)OSTimeGet())
+#endif
+
+typedef struct{
+	const char *name;
+	u32_t enqueued;
+	u32_t dequeued;
+	u32_t drops;				/* posts refused by credits or a full queue, frames without a GI_PACKET */
+	u16_t depth;				/* entries in the queue */
+	u16_t maxDepth;			/* high watermark of depth */
+	u32_t latencyMin;			/* enqueue to dequeue, GI_STATS_TIME units */
+	u32_t latencyMax;
+	u32_t latencySum;
+	u32_t hist[GI_STATS_HIST_BINS];
+}GI_LINK_STATS;
+
+void GI_Stats_Init(void);
+GI_LINK_STATS* GI_Stats_Register(const char *name);
+void GI_Stats_Enqueue(GI_LINK_STATS *stats);
+void GI_Stats_Dequeue(GI_LINK_STATS *stats, u32_t enqueueTime);
+void GI_Stats_Drop(GI_LINK_STATS *stats);
+void GI_Stats_Cancel(GI_LINK_STATS *stats);
+int GI_Stats_Snapshot(GI_LINK_STATS *buf, int maxLinks);
+void GI_Stats_Reset(void);
+
+/* Enqueue is counted before the post, the receiving task may run before the
+ * post returns. A failed post is taken back with GI_STATS_CANCEL. */
+#define GI_STATS_INIT()					GI_Stats_Init()
+#define GI_STATS_REGISTER(s, name)			(s) = GI_Stats_Register(name)
+#define GI_STATS_STAMP(t)					(t) = GI_STATS_TIME()
+#define GI_STATS_ENQUEUE(s)				GI_Stats_Enqueue(s)
+#define GI_STATS_DEQUEUE(s, t)				GI_Stats_Dequeue(s, t)
+#define GI_STATS_DROP(s)					GI_Stats_Drop(s)
+#define GI_STATS_CANCEL(s)					GI_Stats_Cancel(s)
+
+#else /* GI_STATS */
+
+#define GI_STATS_INIT()
+#define GI_STATS_REGISTER(s, name)
+#define GI_STATS_STAMP(t)
+#define GI_STATS_ENQUEUE(s)
+#define GI_STATS_DEQUEUE(s, t)
+#define GI_STATS_DROP(s)
+#define GI_STATS_CANCEL(s)
+
+#endif /* GI_STATS */
+
+#endif /* SRC_MODULES_IDA_LWIP_SRC_INCLUDE_GI_MODULES_GI_STATS_H_ */
@@ -69,6 +69,10 @@ struct ip_reassdata {
 
 void ip_reass_init(void);
 void ip_reass_tmr(void);
+#if LWIP_TIMERS_ON_DEMAND
+u8_t ip_reass_tmr_needed(void);
+void ip_reass_timer_needed(void);
+#endif /* LWIP_TIMERS_ON_DEMAND */
 struct pbuf * ip4_reass(struct pbuf *p);
 #endif /* IP_REASSEMBLY */
 
@@ -120,6 +120,16 @@
 #if !defined LWIP_TIMERS_CUSTOM || defined __DOXYGEN__
 #define LWIP_TIMERS_CUSTOM              0
 #endif
+
+/**
+ * LWIP_TIMERS_ON_DEMAND==1: Run the ARP and IP reassembly timers only while
+ * there are ARP entries to age or datagrams to reassemble, like the TCP timer.
+ * An idle stack then has no periodic wakeups of these timers, which lets a
+ * tickless port sleep longer (see sys_timeouts_sleeptime()).
+ */
+#if !defined LWIP_TIMERS_ON_DEMAND || defined __DOXYGEN__
+#define LWIP_TIMERS_ON_DEMAND           0
+#endif
 /**
  * @}
  */
@@ -2279,6 +2289,17 @@
 #define LWIP_CHECKSUM_CTRL_PER_NETIF    0
 #endif
 
+/**
+ * LWIP_CHECKSUM_RX_OFFLOAD==1: Netif drivers mark received packets whose
+ * checksums the MAC has checked with PBUF_FLAG_CSUM_OK or PBUF_FLAG_CSUM_BAD.
+ * The CHECKSUM_CHECK_* code skips the software pass over the payload for them
+ * (the IP header is still checked in software for PBUF_FLAG_CSUM_BAD, to tell
+ * header from payload errors). Packets without a flag are checked as before.
+ */
+#if !defined LWIP_CHECKSUM_RX_OFFLOAD || defined __DOXYGEN__
+#define LWIP_CHECKSUM_RX_OFFLOAD        0
+#endif
+
 /**
  * CHECKSUM_GEN_IP==1: Generate checksums in software for outgoing IP packets.
  */
@@ -181,6 +181,22 @@ typedef enum {
 #define PBUF_FLAG_LLMCAST   0x10U
 /** indicates this pbuf includes a TCP FIN flag */
 #define PBUF_FLAG_TCP_FIN   0x20U
+/** indicates the MAC has verified the IP header and TCP/UDP/ICMP checksums
+    of this received packet (see LWIP_CHECKSUM_RX_OFFLOAD) */
+#define PBUF_FLAG_CSUM_OK   0x40U
+/** indicates the MAC has found a wrong IP header or TCP/UDP/ICMP checksum
+    in this received packet (see LWIP_CHECKSUM_RX_OFFLOAD) */
+#define PBUF_FLAG_CSUM_BAD  0x80U
+
+#if LWIP_CHECKSUM_RX_OFFLOAD
+/** The checksums of received packet p need no software check */
+#define PBUF_CHECKSUM_VERIFIED(p) (((p)->flags & PBUF_FLAG_CSUM_OK) != 0)
+/** The MAC has found a checksum error in received packet p */
+#define PBUF_CHECKSUM_FAILED(p)   (((p)->flags & PBUF_FLAG_CSUM_BAD) != 0)
+#else /* LWIP_CHECKSUM_RX_OFFLOAD */
+#define PBUF_CHECKSUM_VERIFIED(p) 0
+#define PBUF_CHECKSUM_FAILED(p)   0
+#endif /* LWIP_CHECKSUM_RX_OFFLOAD */
 
 /** Main packet buffer struct */
 struct pbuf {
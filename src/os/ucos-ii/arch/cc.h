@@ -76,4 +76,18 @@
 #define LWIP_PLATFORM_ASSERT(x) do {                \
     } while (0)
 
+/* With LWIP_TCPIP_CORE_LOCKING and LWIP_COMPAT_MUTEX set to 0 the core lock is a native mutex.
+ * Put these into lwipopts.h to have every core call checked against the lock (or the
+ * tcpip_thread without core locking), they are implemented in sys_arch.c:
+ *   #define LWIP_ASSERT_CORE_LOCKED()		sys_check_core_locking()
+ *   #define LWIP_MARK_TCPIP_THREAD()		sys_mark_tcpip_thread()
+ * LWIP_PLATFORM_ASSERT is empty, violations are counted as SYS_CORE_LOCKING_ERR (getSysArchErrorCount).
+ */
+void sys_check_core_locking(void);
+void sys_mark_tcpip_thread(void);
+
+/* stats_display prints the counters of the port as well */
+#define LWIP_PORT_STATS_DISPLAY()		sys_arch_stats_display()
+void sys_arch_stats_display(void);
+
 #endif /* CC_H_ */
@@ -8,7 +8,52 @@
 #ifndef PERF_H_
 #define PERF_H_
 
-#define PERF_START    /* null definition */
-#define PERF_STOP(x)  /* null definition */
+#include <stdint.h>
+
+/* PERF_START/PERF_STOP take the cycles between them and count them per call site,
+ * one site per name given to PERF_STOP. The cycle counter is the one of the port
+ * (SYS_ARCH_CYCLES, the DWT on a Cortex-M7), in the host simulation a clock in ns.
+ */
+#ifndef PERF_CYCLES
+#ifdef SYS_ARCH_CYCLES
+#define PERF_CYCLES()			SYS_ARCH_CYCLES()
+#else
+#error "LWIP_PERF needs a cycle counter, define SYS_ARCH_CYCLES or PERF_CYCLES"
+#endif
+#endif
+
+/* Max. number of call sites */
+#ifndef PERF_MAX_SITES
+#define PERF_MAX_SITES			16
+#endif
+
+/* Histogram bins, bin 0 counts less than 2^(PERF_HIST_SHIFT + 1) cycles, bin n
+ * 2^(PERF_HIST_SHIFT + n) to 2^(PERF_HIST_SHIFT + n + 1) - 1 cycles, the last bin everything longer */
+#ifndef PERF_HIST_BINS
+#define PERF_HIST_BINS			16
+#endif
+#ifndef PERF_HIST_SHIFT
+#define PERF_HIST_SHIFT			5
+#endif
+
+typedef struct perf_site {
+	const char *name;
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t hist[PERF_HIST_BINS];
+} PERF_SITE;
+
+#define PERF_START				uint32_t _perfStart = PERF_CYCLES()
+#define PERF_STOP(x)			do { static PERF_SITE *_perfSite; \
+									perf_record(&_perfSite, (x), PERF_CYCLES() - _perfStart); } while (0)
+
+void perf_record(PERF_SITE **site, const char *name, uint32_t cycles);
+int perf_get(int index, PERF_SITE *site);
+void perf_reset(void);
+void perf_display(void);
+struct udp_pcb;
+int perf_udp_send(struct udp_pcb *pcb);
 
 #endif /* PERF_H_ */
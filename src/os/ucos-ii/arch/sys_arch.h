@@ -16,14 +16,171 @@
 
 typedef OS_EVENT * sys_sem_t;
 typedef OS_EVENT * sys_mbox_t;
+typedef struct sys_arch_mutex * sys_mutex_t;
 typedef uint8_t sys_thread_t;
 
 typedef OS_CPU_SR sys_prot_t;
 sys_prot_t sys_arch_protect(void);
 void sys_arch_unprotect(sys_prot_t pval);
 
+/* Mailbox buffers come from a static pool, thread stacks from a static stack space, sized here or in lwipopts.h.
+ * SYS_ARCH_MBOX_MAX_SIZE is the largest size passed to sys_mbox_new (TCPIP_MBOX_SIZE,
+ * DEFAULT_*_RECVMBOX_SIZE, the 64 entries of the ps7 recv_q, ...).
+ * SYS_ARCH_THREAD_POOL_SIZE is the number of threads in the registry, SYS_ARCH_THREAD_STACK_SIZE (in OS_STK)
+ * the stack a thread gets at least unless the thread profile says otherwise, see sys_arch_thread_profile.
+ */
+#ifndef SYS_ARCH_MBOX_POOL_SIZE
+#define SYS_ARCH_MBOX_POOL_SIZE			16
+#endif
+#ifndef SYS_ARCH_MBOX_MAX_SIZE
+#define SYS_ARCH_MBOX_MAX_SIZE			64
+#endif
+#ifndef SYS_ARCH_THREAD_POOL_SIZE
+#define SYS_ARCH_THREAD_POOL_SIZE		4
+#endif
+#ifndef SYS_ARCH_THREAD_STACK_SIZE
+#define SYS_ARCH_THREAD_STACK_SIZE		768
+#endif
+#ifndef SYS_ARCH_THREAD_STACK_SPACE
+#define SYS_ARCH_THREAD_STACK_SPACE		(SYS_ARCH_THREAD_POOL_SIZE * SYS_ARCH_THREAD_STACK_SIZE)
+#endif
+#ifndef SYS_ARCH_THREAD_NAME_LEN
+#define SYS_ARCH_THREAD_NAME_LEN		16
+#endif
+
+/* Longest timeout of a single OSSemPend/OSQPend in ticks, longer timeouts are waited in steps */
+#ifndef SYS_ARCH_MAX_PEND_TICKS
+#define SYS_ARCH_MAX_PEND_TICKS			0xFFFF
+#endif
+
+/* Optional free running 32 bit cycle counter for the time spent waiting in sys_arch_sem_wait and
+ * sys_arch_mbox_fetch. Without it the time is measured in ticks. On a Cortex-M7 e.g.:
+ *   #define SYS_ARCH_CYCLES_INIT()	do{ CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; DWT->CYCCNT = 0; DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk; }while(0)
+ *   #define SYS_ARCH_CYCLES()		(DWT->CYCCNT)
+ *   #define SYS_ARCH_CYCLES_PER_MS	(SystemCoreClock / 1000)
+ */
+#ifndef SYS_ARCH_CYCLES_INIT
+#define SYS_ARCH_CYCLES_INIT()
+#endif
+
+/* SYS_ARCH_TCPIP_EVENTS==1: the tcpip_thread waits on an OSFlag group instead of its mailbox only.
+ * Besides API messages it wakes up on events of drivers (e.g. RX ring not empty), the handler of
+ * an event runs in the tcpip_thread with the core locked, so a driver can hand its frames to
+ * ethernet_input directly instead of posting a message per frame.
+ * Bit 0 of the group is the mailbox, so an event id is 1..SYS_ARCH_TCPIP_EVENT_MAX and
+ * SYS_ARCH_TCPIP_EVENT_MAX has to be smaller than OS_FLAGS_NBITS.
+ */
+#ifndef SYS_ARCH_TCPIP_EVENTS
+#define SYS_ARCH_TCPIP_EVENTS			0
+#endif
+#ifndef SYS_ARCH_TCPIP_EVENT_MAX
+#define SYS_ARCH_TCPIP_EVENT_MAX		4
+#endif
+
+/* SYS_ARCH_TICKLESS==1: sys_arch_idle, called from OSTaskIdleHook, lets the CPU sleep until the
+ * first task delay expires instead of waking up on every tick. The tcpip_thread pends with the time
+ * of sys_timeouts_sleeptime(), so an idle stack sleeps until its next timeout (few of them with
+ * LWIP_TIMERS_ON_DEMAND). The board provides SYS_ARCH_TICKLESS_SLEEP(ticks): it is called with
+ * interrupts disabled, programs the tick timer to expire after ticks, sleeps (WFI) and returns the
+ * number of ticks that have passed and have not been announced by the tick interrupt, any interrupt
+ * may end the sleep earlier. Sleeps shorter than SYS_ARCH_TICKLESS_MIN_TICKS are not worth it,
+ * SYS_ARCH_TICKLESS_MAX_TICKS is the limit of the timer.
+ */
+#ifndef SYS_ARCH_TICKLESS
+#define SYS_ARCH_TICKLESS				0
+#endif
+#ifndef SYS_ARCH_TICKLESS_MIN_TICKS
+#define SYS_ARCH_TICKLESS_MIN_TICKS		2
+#endif
+#ifndef SYS_ARCH_TICKLESS_MAX_TICKS
+#define SYS_ARCH_TICKLESS_MAX_TICKS		0xFFFF
+#endif
+
+/* SYS_ARCH_PBUF_FREE_DEFER==1: pbufs released in interrupts (e.g. TX complete of an EMAC) are put
+ * into a ring by sys_arch_pbuf_free_fromisr instead of walking the chain with interrupts disabled.
+ * The ring is drained by a tcpip_thread event, so this needs SYS_ARCH_TCPIP_EVENTS.
+ * SYS_ARCH_PBUF_FREE_QUEUE_SIZE has to be a power of two, if the ring is full the pbuf is freed directly.
+ */
+#ifndef SYS_ARCH_PBUF_FREE_DEFER
+#define SYS_ARCH_PBUF_FREE_DEFER		0
+#endif
+#ifndef SYS_ARCH_PBUF_FREE_QUEUE_SIZE
+#define SYS_ARCH_PBUF_FREE_QUEUE_SIZE	32
+#endif
+#if SYS_ARCH_PBUF_FREE_DEFER
+#if !SYS_ARCH_TCPIP_EVENTS
+#error "SYS_ARCH_PBUF_FREE_DEFER needs SYS_ARCH_TCPIP_EVENTS"
+#endif
+#if SYS_ARCH_PBUF_FREE_QUEUE_SIZE <= 0 || (SYS_ARCH_PBUF_FREE_QUEUE_SIZE & (SYS_ARCH_PBUF_FREE_QUEUE_SIZE - 1))
+#error "SYS_ARCH_PBUF_FREE_QUEUE_SIZE has to be a power of two"
+#endif
+#endif /* SYS_ARCH_PBUF_FREE_DEFER */
+
+/* Mutexes are OSMutexes with priority inheritance. Every mutex needs a priority of its own
+ * that is raised to while a lower priority task holds it, so SYS_ARCH_MUTEX_MAX priorities
+ * starting at SYS_ARCH_MUTEX_PRIO_BASE are reserved. They have to be unused and higher
+ * (lower number) than every task that calls into lwIP. lwIP itself takes the core lock and
+ * the heap mutex, every netconn with LWIP_NETCONN_FULLDUPLEX takes another one.
+ */
+#ifndef SYS_ARCH_MUTEX_PRIO_BASE
+#define SYS_ARCH_MUTEX_PRIO_BASE		4
+#endif
+#ifndef SYS_ARCH_MUTEX_MAX
+#define SYS_ARCH_MUTEX_MAX				4
+#endif
 
-/* Bit-Positions of Errors in the sysArchError Variable
+typedef struct {
+	uint16_t size;				/* number of blocks in the pool */
+	uint16_t used;
+	uint16_t maxUsed;			/* high-watermark of used */
+	uint16_t failed;			/* requests while the pool was empty */
+} SYS_ARCH_POOL_STATS;
+
+/* Bins of the wait time histograms, bin 0 counts waits below 1 ms, bin n waits of
+ * 2^(n-1) to 2^n - 1 ms, the last bin everything longer */
+#ifndef SYS_ARCH_WAIT_HIST_BINS
+#define SYS_ARCH_WAIT_HIST_BINS			8
+#endif
+
+typedef struct {
+	uint32_t waits;				/* semaphores taken or messages fetched */
+	uint32_t timeouts;
+	uint32_t hist[SYS_ARCH_WAIT_HIST_BINS];	/* time blocked until taken or fetched */
+} SYS_ARCH_WAIT_STATS;
+
+typedef struct {
+	uint16_t size;				/* entries of the queue */
+	uint16_t maxUsed;			/* high-watermark of the entries */
+	uint32_t posted;
+	uint32_t full;				/* posts dropped because the queue was full */
+	uint32_t errors;			/* posts failed for other reasons */
+	SYS_ARCH_WAIT_STATS fetch;
+	uint8_t valid;				/* mailbox exists */
+} SYS_ARCH_MBOX_STATS;
+
+typedef struct {
+	const char *name;
+	uint8_t prio;				/* task using the stack, 0 if the entry is free */
+	uint16_t size;				/* in OS_STK */
+	uint16_t used;				/* high-watermark in OS_STK, from OSTaskStkChk */
+} SYS_ARCH_STACK_STATS;
+
+/* Entry of the thread profile, 0 keeps what the creator of the thread asks for */
+typedef struct {
+	char name[SYS_ARCH_THREAD_NAME_LEN];
+	uint8_t prio;
+	uint16_t stackSize;			/* in OS_STK */
+} SYS_ARCH_THREAD_PROFILE;
+
+typedef struct {
+	uint16_t size;				/* entries of the ring */
+	uint16_t maxUsed;			/* high-watermark of the entries */
+	uint32_t deferred;			/* pbufs put into the ring */
+	uint32_t full;				/* pbufs freed directly because the ring was full */
+	uint32_t batches;			/* runs of the drain that freed pbufs */
+} SYS_ARCH_PBUF_FREE_STATS;
+
+/* Ids of the errors counted by the port, see getSysArchErrorCount
  *
  */
 #define SYS_INIT_ERR					0
@@ -41,7 +198,45 @@ void sys_arch_unprotect(sys_prot_t pval);
 #define SYS_THREAD_NEW_STACK_ERR		12
 #define SYS_THREAD_NEW_CREATE_ERR		13
 #define SYS_THREAD_NEW_NAME_ERR		14
+#define SYS_MUTEX_NEW_ERR			15
+#define SYS_MUTEX_LOCK_ERR			16
+#define SYS_MUTEX_UNLOCK_ERR			17
+#define SYS_MUTEX_FREE_ERR			18
+#define SYS_TCPIP_EVENT_ERR			19
+#define SYS_MBOX_TRYPOST_ISR_ERR		20
+#define SYS_THREAD_NEW_DUP_ERR		21
+#define SYS_CORE_LOCKING_ERR			22
+#define SYS_ARCH_ERR_COUNT			23
+
+#if SYS_ARCH_TCPIP_EVENTS
+void sys_arch_tcpip_bind(sys_mbox_t *mbox);
+int sys_arch_tcpip_event_new(void (*handler)(void *arg), void *arg);
+void sys_arch_tcpip_event_signal(int event);
+#endif /* SYS_ARCH_TCPIP_EVENTS */
+
+#if SYS_ARCH_TICKLESS
+void sys_arch_idle(void);
+#endif /* SYS_ARCH_TICKLESS */
+
+#if SYS_ARCH_PBUF_FREE_DEFER
+struct pbuf;
+void sys_arch_pbuf_free_fromisr(struct pbuf *p);
+void sys_arch_pbuf_free_drain(void);
+void getSysArchPbufFreeStats(SYS_ARCH_PBUF_FREE_STATS *stats);
+#endif /* SYS_ARCH_PBUF_FREE_DEFER */
+
+int sys_arch_thread_profile(const SYS_ARCH_THREAD_PROFILE *profile, int count);
+int sys_arch_thread_prio(const char *name, int prio);
+int sys_arch_thread_register(const char *name, int prio, int stacksize);
+sys_thread_t sys_arch_thread_find(const char *name);
 
 uint32_t getSysArchError();
+uint32_t getSysArchErrorCount(int id);
+void getSysArchMboxPoolStats(SYS_ARCH_POOL_STATS *stats);
+void getSysArchStackPoolStats(SYS_ARCH_POOL_STATS *stats);
+int getSysArchMboxStats(int index, SYS_ARCH_MBOX_STATS *stats);
+int getSysArchStackStats(int index, SYS_ARCH_STACK_STATS *stats);
+uint32_t getSysArchStackSpaceFree(void);
+void getSysArchSemStats(SYS_ARCH_WAIT_STATS *stats);
 
 #endif /* SYS_ARCH_H_ */
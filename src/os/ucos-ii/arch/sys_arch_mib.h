@@ -0,0 +1,30 @@
+/*
+ * sys_arch_mib.h
+ *
+ *  Created on: 17.10.2026
+ */
+
+#ifndef SYS_ARCH_MIB_H_
+#define SYS_ARCH_MIB_H_
+
+#include "lwip/apps/snmp_opts.h"
+
+#if LWIP_SNMP
+
+#include "lwip/apps/snmp_core.h"
+
+/* Private MIB with the counters of the port, add it with snmp_set_mibs.
+ * Replace the lwIP enterprise number with the one of the device.
+ *   .1 sysArchErrorTable	errorCount
+ *   .2 sysArchMboxTable	size, maxUsed, posted, full, errors, fetched, timeouts
+ *   .3 sysArchStackTable	prio, size, used
+ */
+#ifndef SYS_ARCH_MIB_OID
+#define SYS_ARCH_MIB_OID			{1, 3, 6, 1, 4, 1, 26381, 2, 1}
+#endif
+
+extern const struct snmp_mib sys_arch_mib;
+
+#endif /* LWIP_SNMP */
+
+#endif /* SYS_ARCH_MIB_H_ */
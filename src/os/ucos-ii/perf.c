@@ -0,0 +1,176 @@
+/*
+ * perf.c
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include "lwip/opt.h"
+
+#if LWIP_PERF
+
+#include "lwip/def.h"
+#include "lwip/udp.h"
+#include "ucos_ii.h"
+#include <string.h>
+#include <stdio.h>
+
+/* Size of the text sent by perf_udp_send, sites that do not fit are left out */
+#ifndef PERF_UDP_BUF_SIZE
+#define PERF_UDP_BUF_SIZE		1024
+#endif
+
+static PERF_SITE _sites[PERF_MAX_SITES];
+static int _siteCount;
+
+/*
+ * Finds the site of a name or takes a new one, NULL if all are used.
+ * Names are compared by content, so several PERF_STOPs of a function count together.
+ */
+static PERF_SITE *_site(const char *name){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	PERF_SITE *site = NULL;
+	int i;
+
+	OS_ENTER_CRITICAL();
+	for (i = 0; i < _siteCount; i++){
+		if (strcmp(_sites[i].name, name) == 0){
+			site = &_sites[i];
+			break;
+		}
+	}
+	if (site == NULL && _siteCount < PERF_MAX_SITES){
+		site = &_sites[_siteCount++];
+		site->name = name;
+		site->min = 0xFFFFFFFF;
+	}
+	OS_EXIT_CRITICAL();
+	return site;
+}
+
+/**
+ * Called by PERF_STOP, the site is looked up once and kept in a static of the call site
+ */
+void perf_record(PERF_SITE **site, const char *name, uint32_t cycles){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	PERF_SITE *s = *site;
+	uint32_t v = cycles >> (PERF_HIST_SHIFT + 1);
+	int bin = 0;
+
+	if (s == NULL){
+		s = _site(name);
+		if (s == NULL)
+			return;
+		*site = s;
+	}
+	while (v != 0 && bin < PERF_HIST_BINS - 1){
+		v >>= 1;
+		bin++;
+	}
+	OS_ENTER_CRITICAL();
+	s->count++;
+	s->sum += cycles;
+	if (cycles < s->min)
+		s->min = cycles;
+	if (cycles > s->max)
+		s->max = cycles;
+	s->hist[bin]++;
+	OS_EXIT_CRITICAL();
+}
+
+/**
+ * Copies the site with the given index (0..PERF_MAX_SITES-1), returns -1 if there is none
+ */
+int perf_get(int index, PERF_SITE *site){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	if (index < 0 || index >= _siteCount)
+		return -1;
+	OS_ENTER_CRITICAL();
+	*site = _sites[index];
+	OS_EXIT_CRITICAL();
+	return 0;
+}
+
+/**
+ * Clears the counters, the sites stay registered
+ */
+void perf_reset(void){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	int i;
+
+	OS_ENTER_CRITICAL();
+	for (i = 0; i < _siteCount; i++){
+		const char *name = _sites[i].name;
+		memset(&_sites[i], 0, sizeof(PERF_SITE));
+		_sites[i].name = name;
+		_sites[i].min = 0xFFFFFFFF;
+	}
+	OS_EXIT_CRITICAL();
+}
+
+/*
+ * One line per site: name count min max avg hist...
+ */
+static int _format(const PERF_SITE *site, char *buf, size_t size){
+	int len, i;
+	uint32_t avg = site->count ? (uint32_t)(site->sum / site->count) : 0;
+
+	len = snprintf(buf, size, "%s %lu %lu %lu %lu", site->name, (unsigned long)site->count,
+			(unsigned long)(site->count ? site->min : 0), (unsigned long)site->max, (unsigned long)avg);
+	for (i = 0; i < PERF_HIST_BINS && len > 0 && (size_t)len < size; i++)
+		len += snprintf(buf + len, size - len, " %lu", (unsigned long)site->hist[i]);
+	if (len > 0 && (size_t)len < size)
+		len += snprintf(buf + len, size - len, "\n");
+	return len;
+}
+
+/**
+ * Prints all sites, called by sys_arch_stats_display
+ */
+void perf_display(void){
+	PERF_SITE site;
+	char line[64 + PERF_HIST_BINS * 11];
+	int i;
+
+	LWIP_PLATFORM_DIAG(("\nPERF name count min max avg hist(2^%d cycles)\n", PERF_HIST_SHIFT + 1));
+	for (i = 0; perf_get(i, &site) == 0; i++){
+		_format(&site, line, sizeof(line));
+		LWIP_PLATFORM_DIAG(("%s", line));
+	}
+}
+
+/**
+ * Sends all sites as text (format as perf_display) on a connected UDP pcb.
+ * Has to be called with the core locked. Returns 0 on success, -1 on error.
+ */
+int perf_udp_send(struct udp_pcb *pcb){
+	static char buf[PERF_UDP_BUF_SIZE];
+	PERF_SITE site;
+	struct pbuf *p;
+	size_t len = 0;
+	int i, n;
+	err_t err;
+
+	for (i = 0; perf_get(i, &site) == 0; i++){
+		n = _format(&site, buf + len, sizeof(buf) - len);
+		if (n < 0 || (size_t)n >= sizeof(buf) - len)
+			break;
+		len += n;
+	}
+	p = pbuf_alloc(PBUF_TRANSPORT, (u16_t)len, PBUF_RAM);
+	if (p == NULL)
+		return -1;
+	MEMCPY(p->payload, buf, len);
+	err = udp_send(pcb, p);
+	pbuf_free(p);
+	return err == ERR_OK ? 0 : -1;
+}
+
+#endif /* LWIP_PERF */
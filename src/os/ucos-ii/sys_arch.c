@@ -43,26 +43,231 @@
 
  */
 
+#include "lwip/opt.h"
 #include "arch/sys_arch.h"
 
 #include "ucos_ii.h"
 #include "lwip/err.h"
-#include "tlsf.h"
 #include "lwip/sys.h"
 #include "lwip/def.h"
 #include "lwip/sys.h"
 #include "lwip/mem.h"
+#include "lwip/tcpip.h"
+#include "lwip/stats.h"
 
 #include "arch/cc.h"
+#include <string.h>
 //#include "lwip/timers.h"
 
-//Some ram-space we need to allocate memory for tasks and mailboxes
-#define LWIP_TLSF_HEAP_SIZE 	4096
+//Mailbox buffers are taken from a fixed size partition, so getting one
+//is O(1) and can only fail if the pool is exhausted, never because of fragmentation.
+static void *_mboxMem[SYS_ARCH_MBOX_POOL_SIZE][SYS_ARCH_MBOX_MAX_SIZE];
+static OS_MEM *_mboxPool;
+static SYS_ARCH_POOL_STATS _mboxPoolStats;
+//Post statistics of every mailbox, indexed like the blocks of the mailbox pool
+static SYS_ARCH_MBOX_STATS _mboxStats[SYS_ARCH_MBOX_POOL_SIZE];
 
-uint32_t tlsfHeap[LWIP_TLSF_HEAP_SIZE];
+//Task stacks are cut from one static space, every thread gets exactly the size of its profile.
+//lwIP threads never end, so a stack is not given back. The space starts and every size is rounded
+//to 8 bytes for the AAPCS, so every stack top is 8 byte aligned.
+#define SYS_ARCH_STACK_ALIGN			((8 + sizeof(OS_STK) - 1) / sizeof(OS_STK))
+static OS_STK _stackMem[SYS_ARCH_THREAD_STACK_SPACE] __attribute__((aligned(8)));
+static uint32_t _stackUsed;
 
-//This Variable stores one bit for every possible error that may occur. So you get an overview how many problems you have
-uint32_t sysArchError = 0;
+//Registry of the threads, the stack pool statistics count its entries
+typedef struct {
+	char name[SYS_ARCH_THREAD_NAME_LEN];
+	uint8_t prio;				//0 if the entry is free
+	uint16_t size;
+} SYS_ARCH_THREAD;
+static SYS_ARCH_THREAD _threads[SYS_ARCH_THREAD_POOL_SIZE];
+static SYS_ARCH_POOL_STATS _stackPoolStats;
+static SYS_ARCH_THREAD_PROFILE _profile[SYS_ARCH_THREAD_POOL_SIZE];
+static int _profileCount;
+//Waits of all semaphores
+static SYS_ARCH_WAIT_STATS _semStats;
+
+#if LWIP_TCPIP_CORE_LOCKING && LWIP_COMPAT_MUTEX
+#warning "The core lock is a binary semaphore without priority inheritance, set LWIP_COMPAT_MUTEX to 0"
+#endif
+
+//Mutexes are taken from a fixed array, the index gives the priority reserved for the mutex
+struct sys_arch_mutex {
+	OS_EVENT *event;
+	uint8_t used;
+	OS_TCB *owner;			//task holding the mutex, its priority changes with the inheritance
+};
+static struct sys_arch_mutex _mutexMem[SYS_ARCH_MUTEX_MAX];
+
+//TCB of the tcpip_thread, see sys_mark_tcpip_thread
+static OS_TCB *_tcpipThread;
+
+#if SYS_ARCH_TCPIP_EVENTS
+//Flag of the tcpip mailbox, the events of the drivers follow
+#define SYS_ARCH_TCPIP_MBOX_FLAG		((OS_FLAGS)1)
+
+typedef struct {
+	void (*handler)(void *arg);
+	void *arg;
+} SYS_ARCH_TCPIP_EVENT;
+
+static OS_FLAG_GRP *_tcpipEvents;
+static OS_FLAGS _tcpipEventMask = SYS_ARCH_TCPIP_MBOX_FLAG;
+static OS_EVENT *_tcpipMbox;
+static SYS_ARCH_TCPIP_EVENT _tcpipEventHandler[SYS_ARCH_TCPIP_EVENT_MAX];
+static int _tcpipEventCount;
+
+static u32_t _tcpipEventFetch(sys_mbox_t * mbox, void **msg, u32_t timeout);
+#endif /* SYS_ARCH_TCPIP_EVENTS */
+
+#if SYS_ARCH_PBUF_FREE_DEFER
+//Ring of pbufs to free, head and tail run freely and are masked on access
+static struct pbuf *_pbufFreeQ[SYS_ARCH_PBUF_FREE_QUEUE_SIZE];
+static volatile uint16_t _pbufFreeHead;
+static volatile uint16_t _pbufFreeTail;
+static int _pbufFreeEvent = -1;
+static SYS_ARCH_PBUF_FREE_STATS _pbufFreeStats = { SYS_ARCH_PBUF_FREE_QUEUE_SIZE };
+
+static void _pbufFreeDrain(void *arg);
+#endif /* SYS_ARCH_PBUF_FREE_DEFER */
+
+//Start of a wait, the cycle counter gives the sub-tick part as long as it has not wrapped
+typedef struct {
+	uint32_t tick;
+#ifdef SYS_ARCH_CYCLES
+	uint32_t cycles;
+#endif
+} SYS_ARCH_STAMP;
+
+//Counts every error that may occur, one counter per error id. So you get an overview how many problems you have
+static uint32_t _errorCount[SYS_ARCH_ERR_COUNT];
+
+static void _error(int id)
+{
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	OS_ENTER_CRITICAL();
+	_errorCount[id]++;
+	OS_EXIT_CRITICAL();
+}
+
+/*
+ * Counts a finished wait, ms is SYS_ARCH_TIMEOUT if the wait timed out
+ */
+static void _waitDone(SYS_ARCH_WAIT_STATS *stats, uint32_t ms)
+{
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	int bin = 0;
+
+	if (ms == SYS_ARCH_TIMEOUT){
+		OS_ENTER_CRITICAL();
+		stats->timeouts++;
+		OS_EXIT_CRITICAL();
+		return;
+	}
+	while (ms != 0 && bin < SYS_ARCH_WAIT_HIST_BINS - 1){
+		ms >>= 1;
+		bin++;
+	}
+	OS_ENTER_CRITICAL();
+	stats->waits++;
+	stats->hist[bin]++;
+	OS_EXIT_CRITICAL();
+}
+
+/*
+ * Takes a block from one of the pools and keeps track of the high-watermark
+ */
+static void *_poolGet(OS_MEM *pool, SYS_ARCH_POOL_STATS *stats)
+{
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	uint8_t err;
+	void *block;
+
+	if (pool == NULL)
+		return NULL;
+	OS_ENTER_CRITICAL();
+	block = OSMemGet(pool, &err);
+	if (block != NULL){
+		stats->used++;
+		if (stats->used > stats->maxUsed)
+			stats->maxUsed = stats->used;
+	} else {
+		stats->failed++;
+	}
+	OS_EXIT_CRITICAL();
+	return block;
+}
+
+/*
+ * Statistics of a mailbox, found by the index of its queue buffer in the mailbox pool
+ */
+static SYS_ARCH_MBOX_STATS *_mboxStatsOf(OS_EVENT *mbox)
+{
+	void **start = ((OS_Q*)mbox->OSEventPtr)->OSQStart;
+	return &_mboxStats[(start - &_mboxMem[0][0]) / SYS_ARCH_MBOX_MAX_SIZE];
+}
+
+/*
+ * Converts a lwIP timeout to ticks, rounded up so a short timeout never becomes 0 (wait forever)
+ */
+static uint32_t _msToTicks(uint32_t ms)
+{
+	uint64_t ticks = ((uint64_t)ms * OS_TICKS_PER_SEC + 999) / 1000;
+	if (ticks > 0xFFFFFFFF)
+		ticks = 0xFFFFFFFF;
+	return (uint32_t)ticks;
+}
+
+static void _stamp(SYS_ARCH_STAMP *start)
+{
+	start->tick = OSTimeGet();
+#ifdef SYS_ARCH_CYCLES
+	start->cycles = SYS_ARCH_CYCLES();
+#endif
+}
+
+/*
+ * Milliseconds since start, not more than the timeout because of rounding.
+ * Never returns SYS_ARCH_TIMEOUT.
+ */
+static uint32_t _elapsedMs(const SYS_ARCH_STAMP *start, uint32_t timeout)
+{
+	uint32_t ticks = OSTimeGet() - start->tick;
+	uint32_t ms;
+#ifdef SYS_ARCH_CYCLES
+	uint32_t cyclesPerMs = SYS_ARCH_CYCLES_PER_MS;
+	//The counter wraps after 0xFFFFFFFF / cyclesPerMs milliseconds, a tick is kept as margin
+	if ((uint64_t)ticks * 1000 / OS_TICKS_PER_SEC + 1000 / OS_TICKS_PER_SEC < 0xFFFFFFFF / cyclesPerMs)
+		ms = (SYS_ARCH_CYCLES() - start->cycles) / cyclesPerMs;
+	else
+#endif
+		ms = (uint32_t)((uint64_t)ticks * 1000 / OS_TICKS_PER_SEC);
+	if (timeout != 0 && ms > timeout)
+		ms = timeout;
+	if (ms == SYS_ARCH_TIMEOUT)
+		ms--;
+	return ms;
+}
+
+/*
+ * Gives a block back to the pool it was taken from
+ */
+static void _poolPut(OS_MEM *pool, SYS_ARCH_POOL_STATS *stats, void *block)
+{
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	OS_ENTER_CRITICAL();
+	if (OSMemPut(pool, block) == OS_ERR_NONE)
+		stats->used--;
+	OS_EXIT_CRITICAL();
+}
 
 
 /*******************************************************************************************************/
@@ -78,15 +283,15 @@ uint32_t sysArchError = 0;
  */
 void sys_init(void)
 {
-	//Initialize TLSF Heap.
-	//Be carefull: TLSF uses Bytes, ucosii is configured to use 32bit words.
-	int i = 0;
-	for(i = 0; i < 100; i++){
-		tlsfHeap[i] = i;
-	}
-	size_t heapSize = init_memory_pool(LWIP_TLSF_HEAP_SIZE * sizeof(uint32_t), tlsfHeap);
-	if (heapSize == 0)
-		sysArchError |= (1 << SYS_INIT_ERR);
+	//Create the mailbox partition, it takes an OS_MEM of OS_MAX_MEM_PART.
+	//Be carefull: OSMemCreate uses Bytes for the block size, ucosii is configured to use 32bit words.
+	uint8_t err;
+	_mboxPool = OSMemCreate(_mboxMem, SYS_ARCH_MBOX_POOL_SIZE, sizeof(_mboxMem[0]), &err);
+	if (err != OS_ERR_NONE)
+		_error(SYS_INIT_ERR);
+	_mboxPoolStats.size = SYS_ARCH_MBOX_POOL_SIZE;
+	_stackPoolStats.size = SYS_ARCH_THREAD_POOL_SIZE;
+	SYS_ARCH_CYCLES_INIT();
 }
 /*
  * -- uint32_t sys_now(void) --
@@ -123,9 +328,11 @@ err_t sys_sem_new(sys_sem_t *sem, u8_t count)
 {
 	*sem = (sys_sem_t) OSSemCreate(count);
 	if (*sem == NULL){
-		sysArchError |= (1 << SYS_SEM_NEW_ERR);
+		_error(SYS_SEM_NEW_ERR);
+		SYS_STATS_INC(sem.err);
 		return ERR_MEM;
 	}
+	SYS_STATS_INC_USED(sem);
 	return ERR_OK;
 }
 
@@ -142,7 +349,8 @@ void sys_sem_free(sys_sem_t *sem)
 	uint8_t err;
 	OSSemDel(*sem, OS_DEL_ALWAYS, &err);
 	if(err != OS_ERR_NONE)
-		sysArchError |= (1 << SYS_SEM_FREE_ERR);
+		_error(SYS_SEM_FREE_ERR);
+	SYS_STATS_DEC(sem.used);
 }
 
 /*
@@ -154,7 +362,7 @@ void sys_sem_signal(sys_sem_t *sem)
 {
 	uint8_t err = OSSemPost(*sem);
 	if(err !=OS_ERR_NONE)
-		sysArchError |= (1 << SYS_SEM_SIGNAL_ERR);
+		_error(SYS_SEM_SIGNAL_ERR);
 }
 
 /*
@@ -164,24 +372,38 @@ void sys_sem_signal(sys_sem_t *sem)
  * The timeout parameter specifies how many milliseconds the function should block before returning;
  * if the function times out, it should return SYS_ARCH_TIMEOUT.
  * If timeout=0, then the function should block indefinitely.
+ * The timeout is rounded up to whole ticks, the time waited is measured with the cycle counter if there is one.
  * If the function acquires the semaphore, it should return how many milliseconds expired while waiting for the semaphore.
  * The function may return 0 if the semaphore was immediately available.
  */
 u32_t sys_arch_sem_wait(sys_sem_t *sem, u32_t timeout)
 {
-	uint32_t startTime = sys_now();
+	SYS_ARCH_STAMP start;
 	uint8_t err;
-	uint32_t ticks = timeout * (OS_TICKS_PER_SEC/1000);
-	if(ticks > 0xFFFF)
-		ticks = 0xFFFF;
-	OSSemPend(*sem, (uint16_t)ticks, &err);
-	if (err == OS_ERR_NONE)
-		return sys_now() - startTime;
-	else{
-//		sysArchError |= (1 << SYS_ARCH_SEM_WAIT_ERR);
-		return SYS_ARCH_TIMEOUT;
-	}
+	uint32_t remaining = _msToTicks(timeout);
+	uint32_t ticks;
+	uint32_t ms;
 
+	_stamp(&start);
+	//Timeouts longer than a single pend are waited in steps, 0 waits forever
+	do {
+		ticks = remaining;
+		if(ticks > SYS_ARCH_MAX_PEND_TICKS)
+			ticks = SYS_ARCH_MAX_PEND_TICKS;
+		OSSemPend(*sem, ticks, &err);
+		if (err == OS_ERR_NONE){
+			ms = _elapsedMs(&start, timeout);
+			_waitDone(&_semStats, ms);
+			return ms;
+		}
+		if (err != OS_ERR_TIMEOUT){
+			_error(SYS_ARCH_SEM_WAIT_ERR);
+			break;
+		}
+		remaining -= ticks;
+	} while (remaining > 0);
+	_waitDone(&_semStats, SYS_ARCH_TIMEOUT);
+	return SYS_ARCH_TIMEOUT;
 }
 
 /*
@@ -208,6 +430,169 @@ void sys_sem_set_invalid(sys_sem_t *sem)
 	*sem = NULL;
 }
 
+/*******************************************************************************************************/
+/* Mutexes																											*/
+/*
+ * Mutexes are used by lwIP for the core lock (LWIP_TCPIP_CORE_LOCKING) and to protect the heap.
+ * With LWIP_COMPAT_MUTEX they are mapped to binary semaphores, otherwise they are OSMutexes,
+ * so a low priority task holding the core lock is raised instead of being preempted by
+ * medium priority tasks while a high priority task waits for the lock.
+ * Mutexes must not be used from interrupts.
+ */
+/*******************************************************************************************************/
+#if !LWIP_COMPAT_MUTEX
+
+/*
+ * -- err_t sys_mutex_new(sys_mutex_t *mutex) --
+ *
+ * Creates a new mutex and returns it through the mutex pointer.
+ * Returns ERR_MEM if all SYS_ARCH_MUTEX_MAX mutexes are in use or the mutex could not be created.
+ */
+err_t sys_mutex_new(sys_mutex_t *mutex)
+{
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	uint8_t err;
+	int i;
+
+	OS_ENTER_CRITICAL();
+	for (i = 0; i < SYS_ARCH_MUTEX_MAX; i++){
+		if (!_mutexMem[i].used)
+			break;
+	}
+	if (i == SYS_ARCH_MUTEX_MAX){
+		OS_EXIT_CRITICAL();
+		_error(SYS_MUTEX_NEW_ERR);
+		SYS_STATS_INC(mutex.err);
+		*mutex = NULL;
+		return ERR_MEM;
+	}
+	_mutexMem[i].used = 1;
+	OS_EXIT_CRITICAL();
+
+	_mutexMem[i].owner = NULL;
+	_mutexMem[i].event = OSMutexCreate(SYS_ARCH_MUTEX_PRIO_BASE + i, &err);
+	if (_mutexMem[i].event == NULL){
+		_mutexMem[i].used = 0;
+		_error(SYS_MUTEX_NEW_ERR);
+		SYS_STATS_INC(mutex.err);
+		*mutex = NULL;
+		return ERR_MEM;
+	}
+	*mutex = &_mutexMem[i];
+	SYS_STATS_INC_USED(mutex);
+	return ERR_OK;
+}
+
+/*
+ * -- void sys_mutex_lock(sys_mutex_t *mutex) --
+ *
+ * Blocks the thread until the mutex can be grabbed.
+ */
+void sys_mutex_lock(sys_mutex_t *mutex)
+{
+	uint8_t err;
+	OSMutexPend((*mutex)->event, 0, &err);
+	if (err != OS_ERR_NONE){
+		_error(SYS_MUTEX_LOCK_ERR);
+		return;
+	}
+	(*mutex)->owner = OSTCBCur;
+}
+
+/*
+ * -- void sys_mutex_unlock(sys_mutex_t *mutex) --
+ *
+ * Releases the mutex previously locked through sys_mutex_lock.
+ */
+void sys_mutex_unlock(sys_mutex_t *mutex)
+{
+	(*mutex)->owner = NULL;
+	if (OSMutexPost((*mutex)->event) != OS_ERR_NONE)
+		_error(SYS_MUTEX_UNLOCK_ERR);
+}
+
+/*
+ * -- void sys_mutex_free(sys_mutex_t *mutex) --
+ *
+ * Deallocates a mutex, its priority can be taken by the next sys_mutex_new.
+ */
+void sys_mutex_free(sys_mutex_t *mutex)
+{
+	uint8_t err;
+	OSMutexDel((*mutex)->event, OS_DEL_ALWAYS, &err);
+	if (err != OS_ERR_NONE)
+		_error(SYS_MUTEX_FREE_ERR);
+	(*mutex)->event = NULL;
+	(*mutex)->used = 0;
+	SYS_STATS_DEC(mutex.used);
+}
+
+/*
+ * -- int sys_mutex_valid(sys_mutex_t *mutex) --
+ *
+ * Checks if a given Pointer to a Mutex is valid.
+ */
+int sys_mutex_valid(sys_mutex_t *mutex)
+{
+	if (*mutex != NULL)
+	{
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * -- sys_mutex_set_invalid(sys_mutex_t *mutex) --
+ *
+ * Sets a given Pointer to a Mutex invalid by setting it to zero.
+ */
+void sys_mutex_set_invalid(sys_mutex_t *mutex)
+{
+	*mutex = NULL;
+}
+
+#endif /* !LWIP_COMPAT_MUTEX */
+
+/*
+ * -- void sys_mark_tcpip_thread(void) --
+ *
+ * Called first thing in the tcpip_thread (LWIP_MARK_TCPIP_THREAD), remembers its TCB.
+ */
+void sys_mark_tcpip_thread(void)
+{
+	_tcpipThread = OSTCBCur;
+}
+
+/*
+ * -- void sys_check_core_locking(void) --
+ *
+ * Checks that lwIP's core functions are not called from an interrupt and either with the core lock
+ * held (LWIP_TCPIP_CORE_LOCKING) or from the tcpip_thread. Calls before tcpip_init are not checked.
+ * Tasks are compared by TCB, the priority of the lock holder is raised while others pend on it.
+ * A violation is counted as SYS_CORE_LOCKING_ERR, LWIP_PLATFORM_ASSERT of cc.h does nothing.
+ */
+void sys_check_core_locking(void)
+{
+	if (OSIntNesting != 0){
+		_error(SYS_CORE_LOCKING_ERR);
+		LWIP_ASSERT("lwIP core called from an interrupt", 0);
+		return;
+	}
+#if LWIP_TCPIP_CORE_LOCKING && !LWIP_COMPAT_MUTEX
+	if (sys_mutex_valid(&lock_tcpip_core) && lock_tcpip_core->owner != OSTCBCur){
+		_error(SYS_CORE_LOCKING_ERR);
+		LWIP_ASSERT("lwIP core called without the core lock", 0);
+	}
+#else
+	if (_tcpipThread != NULL && _tcpipThread != OSTCBCur){
+		_error(SYS_CORE_LOCKING_ERR);
+		LWIP_ASSERT("lwIP core called outside of the tcpip_thread", 0);
+	}
+#endif
+}
+
 /*******************************************************************************************************/
 /* Mailboxes																											*/
 /*
@@ -228,24 +613,44 @@ void sys_sem_set_invalid(sys_sem_t *sem)
  * -- err_t sys_mbox_new(sys_mbox_t * mbox, int size) --
  *
  * Trys to create a new mailbox and return it via the mbox pointer provided as argument to the function.
+ * The queue buffer is taken from the mailbox pool, a size of 0 gets the full SYS_ARCH_MBOX_MAX_SIZE.
  * Returns ERR_OK if a mailbox was created and ERR_MEM if the mailbox on error.
  */
 err_t sys_mbox_new(sys_mbox_t * mbox, int size)
 {
-	uint32_t *mem;
-	mem = malloc_ex(size * sizeof(uint32_t), tlsfHeap);
+	void **mem;
+	SYS_ARCH_MBOX_STATS *stats;
+
+	if (size <= 0)
+		size = SYS_ARCH_MBOX_MAX_SIZE;
+	if (size > SYS_ARCH_MBOX_MAX_SIZE)
+	{
+		_error(SYS_MBOX_NEW_MALLOC_ERR);
+		SYS_STATS_INC(mbox.err);
+		return ERR_MEM;
+	}
+
+	mem = _poolGet(_mboxPool, &_mboxPoolStats);
 	if (mem == NULL)
 	{
-		sysArchError |= (1 << SYS_MBOX_NEW_MALLOC_ERR);
+		_error(SYS_MBOX_NEW_MALLOC_ERR);
+		SYS_STATS_INC(mbox.err);
 		return ERR_MEM;
 	}
 
-	*mbox = OSQCreate((void*) mem, size);
+	*mbox = OSQCreate(mem, size);
 	if (*mbox == NULL)
 	{
-		sysArchError |= (1 << SYS_MBOX_NEW_QCREATE_ERR);
+		_poolPut(_mboxPool, &_mboxPoolStats, mem);
+		_error(SYS_MBOX_NEW_QCREATE_ERR);
+		SYS_STATS_INC(mbox.err);
 		return ERR_MEM;
 	}
+	stats = _mboxStatsOf(*mbox);
+	memset(stats, 0, sizeof(SYS_ARCH_MBOX_STATS));
+	stats->size = size;
+	stats->valid = 1;
+	SYS_STATS_INC_USED(mbox);
 	return ERR_OK;
 }
 
@@ -261,11 +666,45 @@ void sys_mbox_free(sys_mbox_t * mbox)
 	uint8_t err;
 	OS_EVENT *mbox_p = *mbox;
 	OS_Q * event_p = mbox_p->OSEventPtr;
-	uint32_t *mem = (uint32_t*) event_p->OSQStart;
+	void **mem = event_p->OSQStart;
+	_mboxStatsOf(*mbox)->valid = 0;
 	OSQDel(*mbox, OS_DEL_ALWAYS, &err);
-	free_ex(mem, tlsfHeap);
+	_poolPut(_mboxPool, &_mboxPoolStats, mem);
 	if(err != OS_ERR_NONE)
-		sysArchError |= (1 << SYS_MBOX_FREE_ERR);
+		_error(SYS_MBOX_FREE_ERR);
+	SYS_STATS_DEC(mbox.used);
+}
+
+/*
+ * Posts to the queue and counts the result in the statistics of the mailbox.
+ * OSQPost does not block, so this is used from tasks and interrupts alike.
+ */
+static uint8_t _mboxPost(sys_mbox_t * mbox, void *msg)
+{
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	SYS_ARCH_MBOX_STATS *stats = _mboxStatsOf(*mbox);
+	OS_Q *q = (OS_Q*)(*mbox)->OSEventPtr;
+	uint8_t err;
+
+	err = OSQPost(*mbox, msg);
+	OS_ENTER_CRITICAL();
+	if (err == OS_ERR_NONE){
+		stats->posted++;
+		if (q->OSQEntries > stats->maxUsed)
+			stats->maxUsed = q->OSQEntries;
+	} else if (err == OS_ERR_Q_FULL){
+		stats->full++;
+	} else {
+		stats->errors++;
+	}
+	OS_EXIT_CRITICAL();
+#if SYS_ARCH_TCPIP_EVENTS
+	if (err == OS_ERR_NONE && *mbox == _tcpipMbox)
+		OSFlagPost(_tcpipEvents, SYS_ARCH_TCPIP_MBOX_FLAG, OS_FLAG_SET, &err);
+#endif
+	return err;
 }
 
 /*
@@ -276,9 +715,9 @@ void sys_mbox_free(sys_mbox_t * mbox)
 void sys_mbox_post(sys_mbox_t * mbox, void *msg)
 {
 	uint8_t err = OS_ERR_NONE;
-	err = OSQPost(*mbox, msg);
+	err = _mboxPost(mbox, msg);
 	if(err != OS_ERR_NONE)
-		sysArchError |= (1 << SYS_MBOX_POST_ERR);
+		_error(SYS_MBOX_POST_ERR);
 }
 
 /*
@@ -291,18 +730,41 @@ void sys_mbox_post(sys_mbox_t * mbox, void *msg)
  */
 u32_t sys_arch_mbox_fetch(sys_mbox_t * mbox, void **msg, u32_t timeout)
 {
-	uint32_t startTime = sys_now();
+	SYS_ARCH_STAMP start;
 	uint8_t err;
-	uint32_t ticks = (timeout * OS_TICKS_PER_SEC)/1000;
-	if(ticks > 0xFFFF)
-		ticks = 0xFFFF;
-	*msg = OSQPend(*mbox, (uint16_t)ticks, &err);
-	if (err == OS_ERR_NONE)
-		return sys_now() - startTime;
-	else{
-//		sysArchError |= (1 << SYS_ARCH_MBOX_FETCH_ERR);
-		return SYS_ARCH_TIMEOUT;
-	}
+	uint32_t remaining = _msToTicks(timeout);
+	uint32_t ticks;
+	uint32_t ms;
+	void *m;
+
+#if SYS_ARCH_TCPIP_EVENTS
+	if (*mbox == _tcpipMbox)
+		return _tcpipEventFetch(mbox, msg, timeout);
+#endif
+	_stamp(&start);
+	//Timeouts longer than a single pend are waited in steps, 0 waits forever
+	do {
+		ticks = remaining;
+		if(ticks > SYS_ARCH_MAX_PEND_TICKS)
+			ticks = SYS_ARCH_MAX_PEND_TICKS;
+		m = OSQPend(*mbox, ticks, &err);
+		if (err == OS_ERR_NONE){
+			if (msg != NULL)
+				*msg = m;
+			ms = _elapsedMs(&start, timeout);
+			_waitDone(&_mboxStatsOf(*mbox)->fetch, ms);
+			return ms;
+		}
+		if (err != OS_ERR_TIMEOUT){
+			_error(SYS_ARCH_MBOX_FETCH_ERR);
+			break;
+		}
+		remaining -= ticks;
+	} while (remaining > 0);
+	_waitDone(&_mboxStatsOf(*mbox)->fetch, SYS_ARCH_TIMEOUT);
+	if (msg != NULL)
+		*msg = NULL;
+	return SYS_ARCH_TIMEOUT;
 }
 
 /*
@@ -329,17 +791,34 @@ u32_t sys_arch_mbox_tryfetch(sys_mbox_t * mbox, void **msg)
  *
  * Tries to post a message to mbox by polling (no timeout).
  * The function returns ERR_OK on success and ERR_MEM if it can't post at the moment.
- *
+ * A full mailbox is only counted in the statistics of the mailbox, it is no error of the port.
  */
 err_t sys_mbox_trypost(sys_mbox_t * mbox, void *msg)
 {
-	int err = OSQPost(*mbox, msg);
+	uint8_t err = _mboxPost(mbox, msg);
 	if(err == OS_ERR_NONE)
 		return ERR_OK;
-	else {
-		sysArchError |= (1 << SYS_MBOX_TRYPOST_ERR);
-		return ERR_MEM;
-	}
+	if(err != OS_ERR_Q_FULL)
+		_error(SYS_MBOX_TRYPOST_ERR);
+	return ERR_MEM;
+}
+
+/*
+ * -- err_t sys_mbox_trypost_fromisr(sys_mbox_t * mbox, void *msg) --
+ *
+ * Same as sys_mbox_trypost, to be used from interrupts (e.g. received frames of an EMAC).
+ * The single producer is the interrupt, the consumer the task fetching from the mailbox.
+ * The OS_Q already is such a ring and OSQPost never blocks, it only disables interrupts for
+ * the few instructions of the insert. The waiting task runs at OSIntExit.
+ */
+err_t sys_mbox_trypost_fromisr(sys_mbox_t * mbox, void *msg)
+{
+	uint8_t err = _mboxPost(mbox, msg);
+	if(err == OS_ERR_NONE)
+		return ERR_OK;
+	if(err != OS_ERR_Q_FULL)
+		_error(SYS_MBOX_TRYPOST_ISR_ERR);
+	return ERR_MEM;
 }
 
 /*
@@ -366,6 +845,229 @@ void sys_mbox_set_invalid(sys_mbox_t *mbox)
 	*mbox = NULL;
 }
 
+#if SYS_ARCH_TCPIP_EVENTS
+/*******************************************************************************************************/
+/* tcpip_thread events																					*/
+/*
+ * The tcpip_thread waits on an OSFlag group that is set by posts to its mailbox and by the events
+ * of the drivers. An event costs one OSFlagPost, no matter how many frames the driver has queued,
+ * and the driver's handler runs in the tcpip_thread, so the frames need no tcpip_msg of their own.
+ */
+/*******************************************************************************************************/
+
+/*
+ * Creates the flag group on first use, drivers may register events before tcpip_init
+ */
+static uint8_t _tcpipEventsCreate(void)
+{
+	uint8_t err = OS_ERR_NONE;
+	if (_tcpipEvents == NULL)
+		_tcpipEvents = OSFlagCreate(0, &err);
+	if (_tcpipEvents == NULL){
+		_error(SYS_TCPIP_EVENT_ERR);
+		return 0;
+	}
+	return 1;
+}
+
+/*
+ * -- void sys_arch_tcpip_bind(sys_mbox_t *mbox) --
+ *
+ * Called by tcpip_init, fetching from this mailbox waits for the events as well.
+ */
+void sys_arch_tcpip_bind(sys_mbox_t *mbox)
+{
+	if (_tcpipEventsCreate())
+		_tcpipMbox = *mbox;
+#if SYS_ARCH_PBUF_FREE_DEFER
+	if (_pbufFreeEvent < 0)
+		_pbufFreeEvent = sys_arch_tcpip_event_new(_pbufFreeDrain, NULL);
+#endif
+}
+
+/*
+ * -- int sys_arch_tcpip_event_new(void (*handler)(void *arg), void *arg) --
+ *
+ * Registers an event, handler(arg) is called in the tcpip_thread with the core locked
+ * every time the event has been signaled. Returns the event id or -1 if there is none left.
+ */
+int sys_arch_tcpip_event_new(void (*handler)(void *arg), void *arg)
+{
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	int event;
+
+	if (!_tcpipEventsCreate())
+		return -1;
+	OS_ENTER_CRITICAL();
+	if (_tcpipEventCount == SYS_ARCH_TCPIP_EVENT_MAX){
+		OS_EXIT_CRITICAL();
+		_error(SYS_TCPIP_EVENT_ERR);
+		return -1;
+	}
+	_tcpipEventHandler[_tcpipEventCount].handler = handler;
+	_tcpipEventHandler[_tcpipEventCount].arg = arg;
+	event = ++_tcpipEventCount;
+	_tcpipEventMask |= (OS_FLAGS)1 << event;
+	OS_EXIT_CRITICAL();
+	return event;
+}
+
+/*
+ * -- void sys_arch_tcpip_event_signal(int event) --
+ *
+ * Wakes up the tcpip_thread to run the handler of the event, may be called from an interrupt.
+ * Signals of an event that has not been handled yet are merged.
+ */
+void sys_arch_tcpip_event_signal(int event)
+{
+	uint8_t err;
+	OSFlagPost(_tcpipEvents, (OS_FLAGS)1 << event, OS_FLAG_SET, &err);
+}
+
+/*
+ * sys_arch_mbox_fetch for the tcpip mailbox. Messages are taken first, then the thread waits for
+ * any flag. After running the handlers SYS_ARCH_TIMEOUT is returned, so the tcpip_thread checks
+ * its timeouts and recalculates the sleep time, the handlers may have added timeouts.
+ */
+static u32_t _tcpipEventFetch(sys_mbox_t * mbox, void **msg, u32_t timeout)
+{
+	SYS_ARCH_STAMP start;
+	uint8_t err;
+	uint32_t remaining = _msToTicks(timeout);
+	uint32_t ticks;
+	uint32_t ms;
+	OS_FLAGS flags;
+	void *m;
+	int i;
+
+	_stamp(&start);
+	do {
+		m = OSQAccept(*mbox, &err);
+		if (err == OS_ERR_NONE){
+			if (msg != NULL)
+				*msg = m;
+			ms = _elapsedMs(&start, timeout);
+			_waitDone(&_mboxStatsOf(*mbox)->fetch, ms);
+			return ms;
+		}
+		ticks = remaining;
+		if(ticks > SYS_ARCH_MAX_PEND_TICKS)
+			ticks = SYS_ARCH_MAX_PEND_TICKS;
+		flags = OSFlagPend(_tcpipEvents, _tcpipEventMask, OS_FLAG_WAIT_SET_ANY | OS_FLAG_CONSUME, ticks, &err);
+		if (err == OS_ERR_NONE){
+			if (flags & ~SYS_ARCH_TCPIP_MBOX_FLAG){
+				LOCK_TCPIP_CORE();
+				for (i = 0; i < _tcpipEventCount; i++){
+					if (flags & ((OS_FLAGS)1 << (i + 1)))
+						_tcpipEventHandler[i].handler(_tcpipEventHandler[i].arg);
+				}
+				UNLOCK_TCPIP_CORE();
+				if (msg != NULL)
+					*msg = NULL;
+				return SYS_ARCH_TIMEOUT;
+			}
+			//only the mailbox flag, the message is taken above
+			continue;
+		}
+		if (err != OS_ERR_TIMEOUT){
+			_error(SYS_ARCH_MBOX_FETCH_ERR);
+			break;
+		}
+		remaining -= ticks;
+	} while (timeout == 0 || remaining > 0);
+	_waitDone(&_mboxStatsOf(*mbox)->fetch, SYS_ARCH_TIMEOUT);
+	if (msg != NULL)
+		*msg = NULL;
+	return SYS_ARCH_TIMEOUT;
+}
+#endif /* SYS_ARCH_TCPIP_EVENTS */
+
+#if SYS_ARCH_PBUF_FREE_DEFER
+/*******************************************************************************************************/
+/* Deferred pbuf free																					*/
+/*
+ * pbuf_free walks the whole chain and takes the pool and heap protection for every pbuf. Done in
+ * a TX complete interrupt this keeps interrupts disabled for a long time under heavy TX, which
+ * delays the RX interrupt. Interrupts only put the pbuf into a ring, the tcpip_thread frees all
+ * of them in one go with the core locked and interrupts enabled.
+ */
+/*******************************************************************************************************/
+
+/*
+ * -- void sys_arch_pbuf_free_fromisr(struct pbuf *p) --
+ *
+ * Frees p later in the tcpip_thread, may be called from interrupts and tasks.
+ * Interrupts are disabled for the insert only. The event is signaled when the ring was empty,
+ * the drain takes everything that has been added meanwhile.
+ */
+void sys_arch_pbuf_free_fromisr(struct pbuf *p)
+{
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	uint16_t used;
+
+	OS_ENTER_CRITICAL();
+	used = (uint16_t)(_pbufFreeHead - _pbufFreeTail);
+	if (used == SYS_ARCH_PBUF_FREE_QUEUE_SIZE || _pbufFreeEvent < 0){
+		_pbufFreeStats.full++;
+		OS_EXIT_CRITICAL();
+		pbuf_free(p);
+		return;
+	}
+	_pbufFreeQ[_pbufFreeHead & (SYS_ARCH_PBUF_FREE_QUEUE_SIZE - 1)] = p;
+	_pbufFreeHead++;
+	_pbufFreeStats.deferred++;
+	if (used + 1 > _pbufFreeStats.maxUsed)
+		_pbufFreeStats.maxUsed = used + 1;
+	OS_EXIT_CRITICAL();
+	if (used == 0)
+		sys_arch_tcpip_event_signal(_pbufFreeEvent);
+}
+
+/*
+ * -- void sys_arch_pbuf_free_drain(void) --
+ *
+ * Frees all pbufs of the ring, called by the event in the tcpip_thread. There is only one consumer:
+ * the entries between tail and the head read at the start stay untouched by the producers until
+ * tail is moved, so they are freed without disabling interrupts.
+ */
+void sys_arch_pbuf_free_drain(void)
+{
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	uint16_t head;
+	uint16_t tail = _pbufFreeTail;
+
+	while (1){
+		OS_ENTER_CRITICAL();
+		head = _pbufFreeHead;
+		if (head == tail){
+			OS_EXIT_CRITICAL();
+			break;
+		}
+		_pbufFreeStats.batches++;
+		OS_EXIT_CRITICAL();
+		while (tail != head){
+			pbuf_free(_pbufFreeQ[tail & (SYS_ARCH_PBUF_FREE_QUEUE_SIZE - 1)]);
+			tail++;
+		}
+		OS_ENTER_CRITICAL();
+		_pbufFreeTail = tail;
+		OS_EXIT_CRITICAL();
+	}
+}
+
+static void _pbufFreeDrain(void *arg)
+{
+	LWIP_UNUSED_ARG(arg);
+	sys_arch_pbuf_free_drain();
+}
+#endif /* SYS_ARCH_PBUF_FREE_DEFER */
+
 /*******************************************************************************************************/
 /* Threads																											*/
 /*
@@ -375,43 +1077,164 @@ void sys_mbox_set_invalid(sys_mbox_t *mbox)
  */
 /*******************************************************************************************************/
 
+/*
+ * Returns the profile entry of a thread or NULL
+ */
+static const SYS_ARCH_THREAD_PROFILE *_profileOf(const char *name)
+{
+	int i;
+	for (i = 0; i < _profileCount; i++){
+		if (strncmp(_profile[i].name, name, SYS_ARCH_THREAD_NAME_LEN - 1) == 0)
+			return &_profile[i];
+	}
+	return NULL;
+}
+
+/*
+ * Adds a thread to the registry, returns the index or -1 if the name or priority is taken or the registry is full
+ */
+static int _threadAdd(const char *name, uint8_t prio, uint16_t size)
+{
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	int i;
+	int free = -1;
+
+	OS_ENTER_CRITICAL();
+	for (i = 0; i < SYS_ARCH_THREAD_POOL_SIZE; i++){
+		if (_threads[i].prio == 0){
+			if (free < 0)
+				free = i;
+		} else if (_threads[i].prio == prio || strncmp(_threads[i].name, name, SYS_ARCH_THREAD_NAME_LEN - 1) == 0){
+			OS_EXIT_CRITICAL();
+			_error(SYS_THREAD_NEW_DUP_ERR);
+			return -1;
+		}
+	}
+	if (free < 0){
+		_stackPoolStats.failed++;
+		OS_EXIT_CRITICAL();
+		_error(SYS_THREAD_NEW_STACK_ERR);
+		return -1;
+	}
+	strncpy(_threads[free].name, name, SYS_ARCH_THREAD_NAME_LEN - 1);
+	_threads[free].name[SYS_ARCH_THREAD_NAME_LEN - 1] = 0;
+	_threads[free].prio = prio;
+	_threads[free].size = size;
+	_stackPoolStats.used++;
+	if (_stackPoolStats.used > _stackPoolStats.maxUsed)
+		_stackPoolStats.maxUsed = _stackPoolStats.used;
+	OS_EXIT_CRITICAL();
+	return free;
+}
+
+static void _threadRemove(int index)
+{
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	OS_ENTER_CRITICAL();
+	_threads[index].prio = 0;
+	_stackPoolStats.used--;
+	OS_EXIT_CRITICAL();
+}
+
+/*
+ * Cuts a stack of size OS_STK from the stack space, NULL if there is not enough left
+ */
+static OS_STK *_stackGet(uint16_t size)
+{
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	OS_STK *stack = NULL;
+
+	OS_ENTER_CRITICAL();
+	if (SYS_ARCH_THREAD_STACK_SPACE - _stackUsed >= size){
+		stack = &_stackMem[_stackUsed];
+		_stackUsed += size;
+	}
+	OS_EXIT_CRITICAL();
+	return stack;
+}
+
+/*
+ * Gives back the stack cut last, if the task could not be created
+ */
+static void _stackPut(OS_STK *stack, uint16_t size)
+{
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	OS_ENTER_CRITICAL();
+	if (stack + size == &_stackMem[_stackUsed])
+		_stackUsed -= size;
+	OS_EXIT_CRITICAL();
+}
+
 /*
  * -- sys_thread_t sys_thread_new(char *name, void (* thread)(void *arg), void *arg, int stacksize, int prio) --
  *
  * name is the thread name. thread(arg) is the call made as the thread's entry point.
  * stacksize is the recommanded stack size for this thread. -> stacksize is in sizeof(OS_STCK) * Bytes
  * prio is the priority that lwIP asks for.
- * Stack size(s) and priority(ies) have to be are defined in lwipopts.h,
- * and so are completely customizable for your system.
+ * Stack size(s) and priority(ies) are defined in lwipopts.h, an entry of the thread profile with the
+ * same name replaces them. Without a profile entry smaller requests get SYS_ARCH_THREAD_STACK_SIZE.
+ * The stack is cut from the stack space. A name or priority that is already in the registry is rejected.
+ * Returns the priority, it is the handle of the thread, or 0 on error.
  */
 sys_thread_t sys_thread_new(const char *name, void(* thread)(void *arg), void *arg, int stacksize, int prio)
 {
+	const SYS_ARCH_THREAD_PROFILE *profile;
 	OS_STK *taskStack;
 	uint8_t err;
+	int index;
 
-	if (prio == 0 || prio >= OS_TASK_IDLE_PRIO)
+	if (name == NULL)
+		name = "";
+	profile = _profileOf(name);
+	if (profile != NULL && profile->prio != 0)
+		prio = profile->prio;
+	if (profile != NULL && profile->stackSize != 0)
+		stacksize = profile->stackSize;
+	else if (stacksize < SYS_ARCH_THREAD_STACK_SIZE)
+		stacksize = SYS_ARCH_THREAD_STACK_SIZE;
+	stacksize = (stacksize + SYS_ARCH_STACK_ALIGN - 1) / SYS_ARCH_STACK_ALIGN * SYS_ARCH_STACK_ALIGN;
+
+	if (prio <= 0 || prio >= OS_TASK_IDLE_PRIO)
+	{
+		_error(SYS_THREAD_NEW_PRIO_ERR);
+		return 0;
+	}
+	if (stacksize > 0xFFFF)
 	{
-		sysArchError |= (1 << SYS_THREAD_NEW_PRIO_ERR);
+		_error(SYS_THREAD_NEW_STACK_ERR);
 		return 0;
 	}
 
-	//Allocate Stack from LWIP-Heap
-	taskStack = (OS_STK*) malloc_ex(stacksize * sizeof(OS_STK), tlsfHeap);
+	index = _threadAdd(name, (uint8_t)prio, (uint16_t)stacksize);
+	if (index < 0)
+		return 0;
+	taskStack = _stackGet((uint16_t)stacksize);
 	if (taskStack == NULL)
 	{
-		sysArchError |= (1 << SYS_THREAD_NEW_STACK_ERR);
+		_threadRemove(index);
+		_error(SYS_THREAD_NEW_STACK_ERR);
 		return 0;
 	}
 
 	//Create Task
 	err = OSTaskCreateExt(thread, arg, &taskStack[stacksize - 1], prio, prio, &taskStack[0], stacksize, (void *) 0, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR);
 	if(err != OS_ERR_NONE){
-		sysArchError |= (1 << SYS_THREAD_NEW_CREATE_ERR);
+		_stackPut(taskStack, (uint16_t)stacksize);
+		_threadRemove(index);
+		_error(SYS_THREAD_NEW_CREATE_ERR);
 		return 0;
 	}
 
 #if (OS_TASK_NAME_EN > 0)
-    OSTaskNameSet(prio,(INT8U *)name,&err);
+    OSTaskNameSet(prio,(INT8U *)_threads[index].name,&err);
 #endif
 
 	if (err == OS_ERR_NONE)
@@ -419,11 +1242,157 @@ sys_thread_t sys_thread_new(const char *name, void(* thread)(void *arg), void *a
 		return prio;
 	} else
 	{
-		sysArchError |= (1 << SYS_THREAD_NEW_NAME_ERR);
+		_error(SYS_THREAD_NEW_NAME_ERR);
 		return 0;
 	}
 }
 
+/*
+ * -- int sys_arch_thread_profile(const SYS_ARCH_THREAD_PROFILE *profile, int count) --
+ *
+ * Loads the thread profile, e.g. read from the configuration at boot. It is copied, so it may be
+ * a temporary buffer. Has to be called before the threads are created, i.e. before tcpip_init.
+ * Returns -1 if there are more than SYS_ARCH_THREAD_POOL_SIZE entries, the first ones are taken anyway.
+ */
+int sys_arch_thread_profile(const SYS_ARCH_THREAD_PROFILE *profile, int count)
+{
+	int i;
+
+	_profileCount = 0;
+	for (i = 0; i < count && i < SYS_ARCH_THREAD_POOL_SIZE; i++){
+		_profile[i] = profile[i];
+		_profile[i].name[SYS_ARCH_THREAD_NAME_LEN - 1] = 0;
+		_profileCount++;
+	}
+	return count > SYS_ARCH_THREAD_POOL_SIZE ? -1 : 0;
+}
+
+/*
+ * -- int sys_arch_thread_prio(const char *name, int prio) --
+ *
+ * Returns the priority of the profile for a task that is not created by sys_thread_new
+ * (e.g. the ethernet input task of a driver), prio if the profile has none.
+ */
+int sys_arch_thread_prio(const char *name, int prio)
+{
+	const SYS_ARCH_THREAD_PROFILE *profile = _profileOf(name);
+	if (profile != NULL && profile->prio != 0)
+		return profile->prio;
+	return prio;
+}
+
+/*
+ * -- int sys_arch_thread_register(const char *name, int prio, int stacksize) --
+ *
+ * Adds a task that is not created by sys_thread_new to the registry, so its stack usage is
+ * reported as well. stacksize is in OS_STK. Returns 0 on success, -1 on error.
+ */
+int sys_arch_thread_register(const char *name, int prio, int stacksize)
+{
+	if (prio <= 0 || prio >= OS_TASK_IDLE_PRIO || stacksize > 0xFFFF){
+		_error(SYS_THREAD_NEW_PRIO_ERR);
+		return -1;
+	}
+	return _threadAdd(name, (uint8_t)prio, (uint16_t)stacksize) < 0 ? -1 : 0;
+}
+
+/*
+ * -- sys_thread_t sys_arch_thread_find(const char *name) --
+ *
+ * Returns the handle (priority) of the thread with this name or 0 if there is none.
+ */
+sys_thread_t sys_arch_thread_find(const char *name)
+{
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	sys_thread_t thread = 0;
+	int i;
+
+	OS_ENTER_CRITICAL();
+	for (i = 0; i < SYS_ARCH_THREAD_POOL_SIZE; i++){
+		if (_threads[i].prio != 0 && strncmp(_threads[i].name, name, SYS_ARCH_THREAD_NAME_LEN - 1) == 0){
+			thread = _threads[i].prio;
+			break;
+		}
+	}
+	OS_EXIT_CRITICAL();
+	return thread;
+}
+
+#if SYS_ARCH_TICKLESS
+#ifndef SYS_ARCH_TICKLESS_SLEEP
+#error "SYS_ARCH_TICKLESS needs SYS_ARCH_TICKLESS_SLEEP(ticks) of the board"
+#endif
+/*
+ * Announces the ticks slept at once, OSTimeTick would walk the task list once per tick. Does what
+ * OSTimeTick does for elapsed ticks: every delay is shortened by them and a task whose delay runs
+ * out is readied, with a timeout if it was pending. Called with interrupts still disabled after the
+ * sleep, so no delay can be set against the stale OSTime and then be shortened by the whole sleep.
+ */
+static void _tickAnnounce(uint32_t elapsed)
+{
+	OS_TCB *ptcb;
+
+	OSTime += elapsed;
+	for (ptcb = OSTCBList; ptcb->OSTCBPrio != OS_TASK_IDLE_PRIO; ptcb = ptcb->OSTCBNext){
+		if (ptcb->OSTCBDly != 0){
+			/* no delay is shorter than the sleep, it was the shortest one */
+			ptcb->OSTCBDly = ptcb->OSTCBDly > elapsed ? ptcb->OSTCBDly - elapsed : 0;
+			if (ptcb->OSTCBDly == 0){
+				if ((ptcb->OSTCBStat & OS_STAT_PEND_ANY) != OS_STAT_RDY){
+					ptcb->OSTCBStat &= (INT8U)~(INT8U)OS_STAT_PEND_ANY;
+					ptcb->OSTCBStatPend = OS_STAT_PEND_TO;
+				} else {
+					ptcb->OSTCBStatPend = OS_STAT_PEND_OK;
+				}
+				if ((ptcb->OSTCBStat & OS_STAT_SUSPEND) == OS_STAT_RDY){
+					OSRdyGrp |= ptcb->OSTCBBitY;
+					OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
+				}
+			}
+		}
+	}
+}
+
+/*
+ * -- void sys_arch_idle(void) --
+ *
+ * To be called from OSTaskIdleHook. Takes the shortest delay of all tasks, the same list OSTimeTick
+ * walks, and sleeps for it. The ticks missed meanwhile are announced in one pass over the tasks
+ * before interrupts are enabled again, the tick hook then runs once per tick. Then the tasks that
+ * have become ready are scheduled, the idle task does not do that by itself.
+ */
+void sys_arch_idle(void)
+{
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	OS_TCB *ptcb;
+	uint32_t ticks = SYS_ARCH_TICKLESS_MAX_TICKS;
+	uint32_t elapsed, i;
+
+	OS_ENTER_CRITICAL();
+	for (ptcb = OSTCBList; ptcb->OSTCBPrio != OS_TASK_IDLE_PRIO; ptcb = ptcb->OSTCBNext){
+		if (ptcb->OSTCBDly != 0 && ptcb->OSTCBDly < ticks)
+			ticks = ptcb->OSTCBDly;
+	}
+	if (ticks < SYS_ARCH_TICKLESS_MIN_TICKS){
+		OS_EXIT_CRITICAL();
+		return;
+	}
+	elapsed = SYS_ARCH_TICKLESS_SLEEP(ticks);
+	if (elapsed != 0)
+		_tickAnnounce(elapsed);
+	OS_EXIT_CRITICAL();
+	if (elapsed == 0)
+		return;
+	for (i = 0; i < elapsed; i++)
+		OSTimeTickHook();
+	OS_Sched();
+}
+#endif /* SYS_ARCH_TICKLESS */
+
 /*
  * This optional function does a "fast" critical region protection and returns
  the previous protection level. This function is only called during very short
@@ -457,8 +1426,172 @@ void sys_arch_unprotect(sys_prot_t cpu_sr) {
 }
 
 /*
- * This function gives you the Error-Flag-Word. Should be zero.
+ * This function gives you the Error-Flag-Word, one bit for every error id that has been counted. Should be zero.
  */
 uint32_t getSysArchError(){
-	return sysArchError;
+	uint32_t mask = 0;
+	int i;
+	for (i = 0; i < SYS_ARCH_ERR_COUNT; i++){
+		if (_errorCount[i] != 0)
+			mask |= (1 << i);
+	}
+	return mask;
+}
+
+/*
+ * This function gives you how often the error with the given id has occurred.
+ */
+uint32_t getSysArchErrorCount(int id){
+	if (id < 0 || id >= SYS_ARCH_ERR_COUNT)
+		return 0;
+	return _errorCount[id];
+}
+
+/*
+ * These functions give you the usage and the high-watermark of the mailbox pool and the thread registry.
+ * A maxUsed equal to size means the pool has been exhausted at least once.
+ */
+void getSysArchMboxPoolStats(SYS_ARCH_POOL_STATS *stats){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	OS_ENTER_CRITICAL();
+	*stats = _mboxPoolStats;
+	OS_EXIT_CRITICAL();
+}
+
+void getSysArchStackPoolStats(SYS_ARCH_POOL_STATS *stats){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	OS_ENTER_CRITICAL();
+	*stats = _stackPoolStats;
+	OS_EXIT_CRITICAL();
+}
+
+/*
+ * This function gives you the post and fetch statistics of the mailbox with the given index (0..SYS_ARCH_MBOX_POOL_SIZE-1).
+ * Returns -1 if the index is out of range. A mailbox that has been freed keeps its statistics
+ * with valid set to zero until the block is used again.
+ */
+int getSysArchMboxStats(int index, SYS_ARCH_MBOX_STATS *stats){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	if (index < 0 || index >= SYS_ARCH_MBOX_POOL_SIZE)
+		return -1;
+	OS_ENTER_CRITICAL();
+	*stats = _mboxStats[index];
+	OS_EXIT_CRITICAL();
+	return 0;
+}
+
+/*
+ * This function gives you the usage of the stack of the thread with the given index (0..SYS_ARCH_THREAD_POOL_SIZE-1).
+ * The high-watermark is taken with OSTaskStkChk, which scans the stack, so call it from a task, not too often.
+ * Returns -1 if the index is out of range.
+ */
+int getSysArchStackStats(int index, SYS_ARCH_STACK_STATS *stats){
+	OS_STK_DATA data;
+
+	if (index < 0 || index >= SYS_ARCH_THREAD_POOL_SIZE)
+		return -1;
+	stats->name = _threads[index].name;
+	stats->prio = _threads[index].prio;
+	stats->size = _threads[index].size;
+	stats->used = 0;
+	if (stats->prio != 0 && OSTaskStkChk(stats->prio, &data) == OS_ERR_NONE)
+		stats->used = data.OSUsed / sizeof(OS_STK);
+	return 0;
+}
+
+/*
+ * This function gives you the space left for the stacks of new threads in OS_STK.
+ */
+uint32_t getSysArchStackSpaceFree(void){
+	return SYS_ARCH_THREAD_STACK_SPACE - _stackUsed;
+}
+
+/*
+ * This function gives you the wait statistics of all semaphores.
+ */
+void getSysArchSemStats(SYS_ARCH_WAIT_STATS *stats){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	OS_ENTER_CRITICAL();
+	*stats = _semStats;
+	OS_EXIT_CRITICAL();
+}
+
+#if SYS_ARCH_PBUF_FREE_DEFER
+/*
+ * Returns the statistics of the deferred pbuf free ring
+ */
+void getSysArchPbufFreeStats(SYS_ARCH_PBUF_FREE_STATS *stats){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	OS_ENTER_CRITICAL();
+	*stats = _pbufFreeStats;
+	OS_EXIT_CRITICAL();
+}
+#endif /* SYS_ARCH_PBUF_FREE_DEFER */
+
+#if LWIP_STATS_DISPLAY
+static void _waitDisplay(const char *name, const SYS_ARCH_WAIT_STATS *stats){
+	int i;
+	LWIP_PLATFORM_DIAG(("%s waits: %"U32_F" timeouts: %"U32_F"\n\thist(ms):", name, stats->waits, stats->timeouts));
+	for (i = 0; i < SYS_ARCH_WAIT_HIST_BINS; i++)
+		LWIP_PLATFORM_DIAG((" %"U32_F, stats->hist[i]));
+	LWIP_PLATFORM_DIAG(("\n"));
+}
+
+/*
+ * Prints the counters of the port, called by stats_display through LWIP_PORT_STATS_DISPLAY
+ */
+void sys_arch_stats_display(void){
+	SYS_ARCH_POOL_STATS pool;
+	SYS_ARCH_MBOX_STATS mbox;
+	SYS_ARCH_STACK_STATS stack;
+	SYS_ARCH_WAIT_STATS sem;
+#if SYS_ARCH_PBUF_FREE_DEFER
+	SYS_ARCH_PBUF_FREE_STATS pbufFree;
+#endif
+	int i;
+
+	LWIP_PLATFORM_DIAG(("\nSYS_ARCH\n"));
+	for (i = 0; i < SYS_ARCH_ERR_COUNT; i++){
+		if (_errorCount[i] != 0)
+			LWIP_PLATFORM_DIAG(("error %d: %"U32_F"\n", i, _errorCount[i]));
+	}
+	getSysArchSemStats(&sem);
+	_waitDisplay("sem", &sem);
+	getSysArchMboxPoolStats(&pool);
+	LWIP_PLATFORM_DIAG(("mbox pool: %"U16_F"/%"U16_F" max: %"U16_F" failed: %"U16_F"\n", pool.used, pool.size, pool.maxUsed, pool.failed));
+	for (i = 0; i < SYS_ARCH_MBOX_POOL_SIZE; i++){
+		getSysArchMboxStats(i, &mbox);
+		if (!mbox.valid)
+			continue;
+		LWIP_PLATFORM_DIAG(("mbox %d: size: %"U16_F" max: %"U16_F" posted: %"U32_F" full: %"U32_F" errors: %"U32_F"\n",
+				i, mbox.size, mbox.maxUsed, mbox.posted, mbox.full, mbox.errors));
+		_waitDisplay("\tfetch", &mbox.fetch);
+	}
+	getSysArchStackPoolStats(&pool);
+	LWIP_PLATFORM_DIAG(("threads: %"U16_F"/%"U16_F" max: %"U16_F" failed: %"U16_F" stack space free: %"U32_F"\n",
+			pool.used, pool.size, pool.maxUsed, pool.failed, getSysArchStackSpaceFree()));
+	for (i = 0; i < SYS_ARCH_THREAD_POOL_SIZE; i++){
+		getSysArchStackStats(i, &stack);
+		if (stack.prio != 0)
+			LWIP_PLATFORM_DIAG(("stack %d: %s prio: %"U16_F" used: %"U16_F"/%"U16_F"\n", i, stack.name, (u16_t)stack.prio, stack.used, stack.size));
+	}
+#if SYS_ARCH_PBUF_FREE_DEFER
+	getSysArchPbufFreeStats(&pbufFree);
+	LWIP_PLATFORM_DIAG(("pbuf free ring: size: %"U16_F" max: %"U16_F" deferred: %"U32_F" full: %"U32_F" batches: %"U32_F"\n",
+			pbufFree.size, pbufFree.maxUsed, pbufFree.deferred, pbufFree.full, pbufFree.batches));
+#endif
+#if LWIP_PERF
+	perf_display();
+#endif
 }
+#endif /* LWIP_STATS_DISPLAY */
@@ -0,0 +1,166 @@
+/*
+ * sys_arch_mib.c
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include "arch/sys_arch_mib.h"
+
+#if LWIP_SNMP
+
+#include "lwip/sys.h"
+#include "lwip/apps/snmp_table.h"
+
+/*
+ * All tables are indexed by 1..n, a row exists if the object is in use
+ */
+static u8_t _rowExists(u8_t table, u32_t index){
+	SYS_ARCH_MBOX_STATS mbox;
+	SYS_ARCH_STACK_STATS stack;
+
+	switch (table){
+	case 1:
+		return index >= 1 && index <= SYS_ARCH_ERR_COUNT;
+	case 2:
+		return getSysArchMboxStats((int)index - 1, &mbox) == 0 && mbox.valid;
+	case 3:
+		return getSysArchStackStats((int)index - 1, &stack) == 0 && stack.prio != 0;
+	default:
+		return 0;
+	}
+}
+
+static snmp_err_t _getValue(u8_t table, u32_t column, u32_t index, union snmp_variant_value *value){
+	SYS_ARCH_MBOX_STATS mbox;
+	SYS_ARCH_STACK_STATS stack;
+
+	if (!_rowExists(table, index))
+		return SNMP_ERR_NOSUCHINSTANCE;
+
+	switch (table){
+	case 1:
+		value->u32 = getSysArchErrorCount((int)index - 1);
+		return SNMP_ERR_NOERROR;
+	case 2:
+		getSysArchMboxStats((int)index - 1, &mbox);
+		switch (column){
+		case 1: value->u32 = mbox.size; break;
+		case 2: value->u32 = mbox.maxUsed; break;
+		case 3: value->u32 = mbox.posted; break;
+		case 4: value->u32 = mbox.full; break;
+		case 5: value->u32 = mbox.errors; break;
+		case 6: value->u32 = mbox.fetch.waits; break;
+		case 7: value->u32 = mbox.fetch.timeouts; break;
+		default: return SNMP_ERR_NOSUCHINSTANCE;
+		}
+		return SNMP_ERR_NOERROR;
+	case 3:
+		getSysArchStackStats((int)index - 1, &stack);
+		switch (column){
+		case 1: value->u32 = stack.prio; break;
+		case 2: value->u32 = stack.size; break;
+		case 3: value->u32 = stack.used; break;
+		default: return SNMP_ERR_NOSUCHINSTANCE;
+		}
+		return SNMP_ERR_NOERROR;
+	default:
+		return SNMP_ERR_NOSUCHINSTANCE;
+	}
+}
+
+static snmp_err_t _getCell(u8_t table, const u32_t *column, const u32_t *row_oid, u8_t row_oid_len, union snmp_variant_value *value){
+	if (row_oid_len != 1)
+		return SNMP_ERR_NOSUCHINSTANCE;
+	return _getValue(table, *column, row_oid[0], value);
+}
+
+static snmp_err_t _getNextCell(u8_t table, u32_t rows, const u32_t *column, struct snmp_obj_id *row_oid, union snmp_variant_value *value){
+	struct snmp_next_oid_state state;
+	u32_t result_temp[1];
+	u32_t index;
+
+	snmp_next_oid_init(&state, row_oid->id, row_oid->len, result_temp, LWIP_ARRAYSIZE(result_temp));
+	for (index = 1; index <= rows; index++){
+		if (_rowExists(table, index))
+			snmp_next_oid_check(&state, &index, 1, NULL);
+	}
+	if (state.status != SNMP_NEXT_OID_STATUS_SUCCESS)
+		return SNMP_ERR_NOSUCHINSTANCE;
+	snmp_oid_assign(row_oid, state.next_oid, state.next_oid_len);
+	return _getValue(table, *column, row_oid->id[0], value);
+}
+
+/* --- sysArchErrorTable --- */
+
+static snmp_err_t _errorTable_get_cell_value(const u32_t *column, const u32_t *row_oid, u8_t row_oid_len, union snmp_variant_value *value, u32_t *value_len){
+	LWIP_UNUSED_ARG(value_len);
+	return _getCell(1, column, row_oid, row_oid_len, value);
+}
+
+static snmp_err_t _errorTable_get_next_cell_instance_and_value(const u32_t *column, struct snmp_obj_id *row_oid, union snmp_variant_value *value, u32_t *value_len){
+	LWIP_UNUSED_ARG(value_len);
+	return _getNextCell(1, SYS_ARCH_ERR_COUNT, column, row_oid, value);
+}
+
+static const struct snmp_table_simple_col_def _errorTable_columns[] = {
+	{ 1, SNMP_ASN1_TYPE_COUNTER, SNMP_VARIANT_VALUE_TYPE_U32 }	/* errorCount */
+};
+
+static const struct snmp_table_simple_node _errorTable = SNMP_TABLE_CREATE_SIMPLE(1, _errorTable_columns, _errorTable_get_cell_value, _errorTable_get_next_cell_instance_and_value);
+
+/* --- sysArchMboxTable --- */
+
+static snmp_err_t _mboxTable_get_cell_value(const u32_t *column, const u32_t *row_oid, u8_t row_oid_len, union snmp_variant_value *value, u32_t *value_len){
+	LWIP_UNUSED_ARG(value_len);
+	return _getCell(2, column, row_oid, row_oid_len, value);
+}
+
+static snmp_err_t _mboxTable_get_next_cell_instance_and_value(const u32_t *column, struct snmp_obj_id *row_oid, union snmp_variant_value *value, u32_t *value_len){
+	LWIP_UNUSED_ARG(value_len);
+	return _getNextCell(2, SYS_ARCH_MBOX_POOL_SIZE, column, row_oid, value);
+}
+
+static const struct snmp_table_simple_col_def _mboxTable_columns[] = {
+	{ 1, SNMP_ASN1_TYPE_GAUGE,   SNMP_VARIANT_VALUE_TYPE_U32 },	/* size */
+	{ 2, SNMP_ASN1_TYPE_GAUGE,   SNMP_VARIANT_VALUE_TYPE_U32 },	/* maxUsed */
+	{ 3, SNMP_ASN1_TYPE_COUNTER, SNMP_VARIANT_VALUE_TYPE_U32 },	/* posted */
+	{ 4, SNMP_ASN1_TYPE_COUNTER, SNMP_VARIANT_VALUE_TYPE_U32 },	/* full */
+	{ 5, SNMP_ASN1_TYPE_COUNTER, SNMP_VARIANT_VALUE_TYPE_U32 },	/* errors */
+	{ 6, SNMP_ASN1_TYPE_COUNTER, SNMP_VARIANT_VALUE_TYPE_U32 },	/* fetched */
+	{ 7, SNMP_ASN1_TYPE_COUNTER, SNMP_VARIANT_VALUE_TYPE_U32 }	/* timeouts */
+};
+
+static const struct snmp_table_simple_node _mboxTable = SNMP_TABLE_CREATE_SIMPLE(2, _mboxTable_columns, _mboxTable_get_cell_value, _mboxTable_get_next_cell_instance_and_value);
+
+/* --- sysArchStackTable --- */
+
+static snmp_err_t _stackTable_get_cell_value(const u32_t *column, const u32_t *row_oid, u8_t row_oid_len, union snmp_variant_value *value, u32_t *value_len){
+	LWIP_UNUSED_ARG(value_len);
+	return _getCell(3, column, row_oid, row_oid_len, value);
+}
+
+static snmp_err_t _stackTable_get_next_cell_instance_and_value(const u32_t *column, struct snmp_obj_id *row_oid, union snmp_variant_value *value, u32_t *value_len){
+	LWIP_UNUSED_ARG(value_len);
+	return _getNextCell(3, SYS_ARCH_THREAD_POOL_SIZE, column, row_oid, value);
+}
+
+static const struct snmp_table_simple_col_def _stackTable_columns[] = {
+	{ 1, SNMP_ASN1_TYPE_GAUGE, SNMP_VARIANT_VALUE_TYPE_U32 },	/* prio */
+	{ 2, SNMP_ASN1_TYPE_GAUGE, SNMP_VARIANT_VALUE_TYPE_U32 },	/* size */
+	{ 3, SNMP_ASN1_TYPE_GAUGE, SNMP_VARIANT_VALUE_TYPE_U32 }	/* used */
+};
+
+static const struct snmp_table_simple_node _stackTable = SNMP_TABLE_CREATE_SIMPLE(3, _stackTable_columns, _stackTable_get_cell_value, _stackTable_get_next_cell_instance_and_value);
+
+static const struct snmp_node *const _nodes[] = {
+	&_errorTable.node.node,
+	&_mboxTable.node.node,
+	&_stackTable.node.node
+};
+
+static const struct snmp_tree_node _root = SNMP_CREATE_TREE_NODE(1, _nodes);
+static const u32_t _baseOid[] = SYS_ARCH_MIB_OID;
+
+const struct snmp_mib sys_arch_mib = SNMP_MIB_CREATE(_baseOid, &_root.node);
+
+#endif /* LWIP_SNMP */
@@ -0,0 +1,229 @@
+/*
+ * eth_cache_test.c
+ *
+ *  Created on: 17.10.2026
+ *
+ * Model of the ETH DMA descriptor rings of the STM32F7 driver. Frames of different
+ * lengths are placed at every ring position and the ranges ethernetif_cache.c
+ * maintains are compared with the cache lines the frame occupies.
+ *
+ * eth_cache_test [-v]
+ *   -v      print every maintained range
+ */
+
+#include "ethernetif_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define LINE							ETH_CACHE_LINE_SIZE
+#define LINE_DOWN(a)					((uintptr_t)(a) & ~(uintptr_t)(LINE - 1))
+#define LINE_UP(a)						LINE_DOWN((uintptr_t)(a) + LINE - 1)
+
+CACHE_OP cacheOps[CACHE_MAX_OPS];
+int cacheOpCount;
+MPU_Region_InitTypeDef mpuRegion;
+int mpuEnabled;
+
+static ETH_DMADescTypeDef _rxDesc[ETH_RXBUFNB];
+static ETH_DMADescTypeDef _txDesc[ETH_TXBUFNB];
+static uint8_t _rxBuff[ETH_RXBUFNB][ETH_RX_BUF_SIZE] __attribute__((aligned(LINE)));
+static uint8_t _txBuff[ETH_TXBUFNB][ETH_TX_BUF_SIZE] __attribute__((aligned(LINE)));
+
+static int _verbose;
+static int _failed;
+
+static void _record(CACHE_OP_KIND kind, uint32_t *addr, int32_t dsize){
+	if (_verbose)
+		printf("  %s %p %ld\n", kind == CACHE_CLEAN ? "clean" : "clean+invalidate", (void*)addr, (long)dsize);
+	if (cacheOpCount < CACHE_MAX_OPS){
+		cacheOps[cacheOpCount].kind = kind;
+		cacheOps[cacheOpCount].addr = (uintptr_t)addr;
+		cacheOps[cacheOpCount].size = dsize;
+	}
+	cacheOpCount++;
+}
+
+void SCB_CleanDCache_by_Addr(uint32_t *addr, int32_t dsize){
+	_record(CACHE_CLEAN, addr, dsize);
+}
+
+void SCB_CleanInvalidateDCache_by_Addr(uint32_t *addr, int32_t dsize){
+	_record(CACHE_CLEAN_INVALIDATE, addr, dsize);
+}
+
+void HAL_MPU_Disable(void){
+	mpuEnabled = 0;
+}
+
+void HAL_MPU_Enable(uint32_t MPU_Control){
+	(void)MPU_Control;
+	mpuEnabled = 1;
+}
+
+void HAL_MPU_ConfigRegion(MPU_Region_InitTypeDef *MPU_Init){
+	mpuRegion = *MPU_Init;
+}
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); _failed++; } } while (0)
+
+/*
+ * Chained ring as set up by HAL_ETH_DMARxDescListInit/HAL_ETH_DMATxDescListInit
+ */
+static void _ring(ETH_DMADescTypeDef *desc, uint8_t *buff, int count, uint32_t size){
+	int i;
+
+	for (i = 0; i < count; i++){
+		desc[i].Buffer1Addr = (uintptr_t)(buff + i * size);
+		desc[i].Buffer2NextDescAddr = (uintptr_t)&desc[(i + 1) % count];
+	}
+}
+
+#if !ETH_DMA_NONCACHEABLE
+/*
+ * The recorded ops have to be exactly the lines of the segments of a frame of length
+ * bytes starting at desc[first], and touch no line that lies entirely in another buffer
+ */
+static void _checkFrame(const char *name, CACHE_OP_KIND kind, ETH_DMADescTypeDef *desc, int count,
+		uint8_t *buff, uint32_t size, int first, uint32_t length){
+	uint32_t left = length;
+	uint32_t n;
+	int seg = 0, i, b;
+
+	while (left > 0){
+		n = left < size ? left : size;
+		i = (first + seg) % count;
+		CHECK(seg < cacheOpCount, "%s first %d length %lu: segment %d not maintained", name, first, (unsigned long)length, seg);
+		if (seg < cacheOpCount && seg < CACHE_MAX_OPS){
+			CACHE_OP *op = &cacheOps[seg];
+			CHECK(op->kind == kind, "%s first %d length %lu: wrong operation", name, first, (unsigned long)length);
+			CHECK(op->addr % LINE == 0 && op->size % LINE == 0, "%s first %d length %lu: range not line aligned", name, first, (unsigned long)length);
+			CHECK(op->addr == LINE_DOWN(desc[i].Buffer1Addr) && op->addr + op->size == LINE_UP(desc[i].Buffer1Addr + n),
+					"%s first %d length %lu: segment %d covers %p+%ld instead of %p+%lu", name, first, (unsigned long)length, seg,
+					(void*)op->addr, (long)op->size, (void*)desc[i].Buffer1Addr, (unsigned long)n);
+			for (b = 0; b < count; b++){
+				uintptr_t lo = LINE_UP(buff + b * size), hi = LINE_DOWN(buff + (b + 1) * size);
+				if (b != i && lo < hi)
+					CHECK(op->addr + op->size <= lo || op->addr >= hi, "%s first %d length %lu: touches buffer %d", name, first, (unsigned long)length, b);
+			}
+		}
+		left -= n;
+		seg++;
+	}
+	CHECK(cacheOpCount == seg, "%s first %d length %lu: %d ranges for %d segments", name, first, (unsigned long)length, cacheOpCount, seg);
+}
+#endif /* !ETH_DMA_NONCACHEABLE */
+
+static const uint32_t _lengths[] = { 1, 42, 60, 64, 1514, ETH_RX_BUF_SIZE - 1, ETH_RX_BUF_SIZE, ETH_RX_BUF_SIZE + 1, 3000, 3 * ETH_RX_BUF_SIZE + 17 };
+
+static void _testRx(void){
+	unsigned l;
+	int first;
+
+	_ring(_rxDesc, &_rxBuff[0][0], ETH_RXBUFNB, ETH_RX_BUF_SIZE);
+	for (first = 0; first < ETH_RXBUFNB; first++){
+		for (l = 0; l < sizeof(_lengths) / sizeof(_lengths[0]); l++){
+			uint32_t length = _lengths[l];
+			uint32_t segs = (length + ETH_RX_BUF_SIZE - 1) / ETH_RX_BUF_SIZE;
+
+			if (segs > ETH_RXBUFNB)
+				continue;
+			if (_verbose)
+				printf("rx first %d length %lu\n", first, (unsigned long)length);
+			cacheOpCount = 0;
+			ethernetif_cache_rx(&_rxDesc[first], segs, length);
+#if ETH_DMA_NONCACHEABLE
+			CHECK(cacheOpCount == 0, "rx: maintenance in non-cacheable mode");
+#else
+			_checkFrame("rx", CACHE_CLEAN_INVALIDATE, _rxDesc, ETH_RXBUFNB, &_rxBuff[0][0], ETH_RX_BUF_SIZE, first, length);
+#endif
+		}
+	}
+	/* the HAL never reports more segments than the length needs, but fewer must not overrun */
+	cacheOpCount = 0;
+	ethernetif_cache_rx(&_rxDesc[0], 1, 2 * ETH_RX_BUF_SIZE);
+#if !ETH_DMA_NONCACHEABLE
+	CHECK(cacheOpCount == 1, "rx: %d ranges for one segment", cacheOpCount);
+#endif
+}
+
+static void _testTx(void){
+	unsigned l;
+	int first;
+
+	_ring(_txDesc, &_txBuff[0][0], ETH_TXBUFNB, ETH_TX_BUF_SIZE);
+	for (first = 0; first < ETH_TXBUFNB; first++){
+		for (l = 0; l < sizeof(_lengths) / sizeof(_lengths[0]); l++){
+			uint32_t length = _lengths[l];
+
+			if (length > ETH_TXBUFNB * ETH_TX_BUF_SIZE)
+				continue;
+			if (_verbose)
+				printf("tx first %d length %lu\n", first, (unsigned long)length);
+			cacheOpCount = 0;
+			ethernetif_cache_tx(&_txDesc[first], length);
+#if ETH_DMA_NONCACHEABLE
+			CHECK(cacheOpCount == 0, "tx: maintenance in non-cacheable mode");
+#else
+			_checkFrame("tx", CACHE_CLEAN, _txDesc, ETH_TXBUFNB, &_txBuff[0][0], ETH_TX_BUF_SIZE, first, length);
+#endif
+		}
+	}
+}
+
+static void _testSpare(void){
+	static uint8_t spare[ETH_RX_BUF_SIZE + LINE] __attribute__((aligned(LINE)));
+
+	/* a spare starting in the middle of a line */
+	cacheOpCount = 0;
+	ethernetif_cache_invalidate(spare + 4, ETH_RX_BUF_SIZE);
+#if ETH_DMA_NONCACHEABLE
+	CHECK(cacheOpCount == 0, "spare: maintenance in non-cacheable mode");
+#else
+	CHECK(cacheOpCount == 1, "spare: %d ranges", cacheOpCount);
+	CHECK(cacheOps[0].kind == CACHE_CLEAN_INVALIDATE, "spare: wrong operation");
+	CHECK(cacheOps[0].addr == LINE_DOWN(spare + 4) && cacheOps[0].addr + cacheOps[0].size == LINE_UP(spare + 4 + ETH_RX_BUF_SIZE),
+			"spare: covers %p+%ld", (void*)cacheOps[0].addr, (long)cacheOps[0].size);
+	cacheOpCount = 0;
+	ethernetif_cache_invalidate(spare, 0);
+	CHECK(cacheOpCount == 0, "spare: range for length 0");
+#endif
+}
+
+static void _testClean(void){
+	static uint8_t payload[200] __attribute__((aligned(LINE)));
+
+	/* scatter-gather TX points into pbufs outside the ETH buffers, cleaned in both modes */
+	cacheOpCount = 0;
+	ethernetif_cache_clean(payload + 54, 100);
+	CHECK(cacheOpCount == 1, "clean: %d ranges", cacheOpCount);
+	CHECK(cacheOps[0].kind == CACHE_CLEAN, "clean: wrong operation");
+	CHECK(cacheOps[0].addr == LINE_DOWN(payload + 54) && cacheOps[0].addr + cacheOps[0].size == LINE_UP(payload + 154),
+			"clean: covers %p+%ld", (void*)cacheOps[0].addr, (long)cacheOps[0].size);
+}
+
+static void _testMpu(void){
+#if ETH_DMA_NONCACHEABLE
+	ethernetif_mpu_config();
+	CHECK(mpuEnabled, "mpu: not enabled again");
+	CHECK(mpuRegion.Enable == MPU_REGION_ENABLE && mpuRegion.BaseAddress == ETH_MPU_REGION_BASE
+			&& mpuRegion.Size == ETH_MPU_REGION_SIZE, "mpu: wrong region");
+	CHECK(mpuRegion.TypeExtField == MPU_TEX_LEVEL1 && mpuRegion.IsCacheable == MPU_ACCESS_NOT_CACHEABLE
+			&& mpuRegion.IsBufferable == MPU_ACCESS_NOT_BUFFERABLE, "mpu: region is not normal non-cacheable memory");
+#endif
+}
+
+int main(int argc, char *argv[]){
+	if (argc > 1 && strcmp(argv[1], "-v") == 0)
+		_verbose = 1;
+
+	_testRx();
+	_testTx();
+	_testSpare();
+	_testClean();
+	_testMpu();
+
+	printf("eth_cache_test (ETH_RX_BUF_SIZE %d, ETH_TX_BUF_SIZE %d, ETH_DMA_NONCACHEABLE %d): %s\n",
+			ETH_RX_BUF_SIZE, ETH_TX_BUF_SIZE, ETH_DMA_NONCACHEABLE, _failed ? "FAILED" : "ok");
+	return _failed ? 1 : 0;
+}
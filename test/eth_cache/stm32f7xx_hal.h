@@ -0,0 +1,80 @@
+/*
+ * stm32f7xx_hal.h
+ *
+ *  Created on: 17.10.2026
+ *
+ * The parts of the HAL and CMSIS used by ethernetif_cache.c. The descriptors hold
+ * host pointers, the maintenance functions only record the ranges they are given.
+ */
+
+#ifndef TEST_ETH_CACHE_STM32F7XX_HAL_H_
+#define TEST_ETH_CACHE_STM32F7XX_HAL_H_
+
+#include <stdint.h>
+
+#define __IO volatile
+
+#ifndef ETH_RX_BUF_SIZE
+#define ETH_RX_BUF_SIZE		1524
+#endif
+#ifndef ETH_TX_BUF_SIZE
+#define ETH_TX_BUF_SIZE		1524
+#endif
+#define ETH_RXBUFNB			4
+#define ETH_TXBUFNB			4
+
+typedef struct {
+	__IO uint32_t Status;
+	uint32_t ControlBufferSize;
+	uintptr_t Buffer1Addr;
+	uintptr_t Buffer2NextDescAddr;
+} ETH_DMADescTypeDef;
+
+typedef enum { CACHE_CLEAN, CACHE_CLEAN_INVALIDATE } CACHE_OP_KIND;
+
+typedef struct {
+	CACHE_OP_KIND kind;
+	uintptr_t addr;
+	int32_t size;
+} CACHE_OP;
+
+#define CACHE_MAX_OPS		16
+extern CACHE_OP cacheOps[CACHE_MAX_OPS];
+extern int cacheOpCount;
+
+void SCB_CleanDCache_by_Addr(uint32_t *addr, int32_t dsize);
+void SCB_CleanInvalidateDCache_by_Addr(uint32_t *addr, int32_t dsize);
+
+#define MPU_REGION_ENABLE				1
+#define MPU_REGION_NUMBER1				1
+#define MPU_REGION_SIZE_16KB			0x0D
+#define MPU_TEX_LEVEL1					1
+#define MPU_REGION_FULL_ACCESS			3
+#define MPU_INSTRUCTION_ACCESS_DISABLE	1
+#define MPU_ACCESS_SHAREABLE			1
+#define MPU_ACCESS_NOT_CACHEABLE		0
+#define MPU_ACCESS_NOT_BUFFERABLE		0
+#define MPU_PRIVILEGED_DEFAULT			4
+
+typedef struct {
+	uint8_t Enable;
+	uint8_t Number;
+	uint32_t BaseAddress;
+	uint8_t Size;
+	uint8_t SubRegionDisable;
+	uint8_t TypeExtField;
+	uint8_t AccessPermission;
+	uint8_t DisableExec;
+	uint8_t IsShareable;
+	uint8_t IsCacheable;
+	uint8_t IsBufferable;
+} MPU_Region_InitTypeDef;
+
+extern MPU_Region_InitTypeDef mpuRegion;
+extern int mpuEnabled;
+
+void HAL_MPU_Disable(void);
+void HAL_MPU_Enable(uint32_t MPU_Control);
+void HAL_MPU_ConfigRegion(MPU_Region_InitTypeDef *MPU_Init);
+
+#endif /* TEST_ETH_CACHE_STM32F7XX_HAL_H_ */
@@ -0,0 +1,20 @@
+/*
+ * cc.h
+ *
+ *  Created on: 17.10.2026
+ */
+
+#ifndef TEST_GI_SIM_ARCH_CC_H_
+#define TEST_GI_SIM_ARCH_CC_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#define LWIP_RAND() ((u32_t)rand())
+
+#define LWIP_PLATFORM_DIAG(x)	do { printf x; } while(0)
+#define LWIP_PLATFORM_ASSERT(x)	do { printf("Assertion \"%s\" failed at line %d in %s\n", \
+									x, __LINE__, __FILE__); fflush(NULL); abort(); } while(0)
+
+#endif /* TEST_GI_SIM_ARCH_CC_H_ */
@@ -0,0 +1,168 @@
+/*
+ * ethernetif_sim.c
+ *
+ *  Created on: 17.10.2026
+ *
+ * Ethernet driver of the host build. The rx ring stands in for the DMA ring,
+ * transmitted frames are counted and optionally written to a pcap file.
+ */
+
+#include "ethernetif_sim.h"
+#include "lwip/etharp.h"
+#include "gi_modules/gi_packet.h"
+#include "gi_modules/gi_stats.h"
+#include "gi_modules/gi_ethernet_module.h"
+#include "gi_modules/gi_ipv4_module.h"
+#include <pthread.h>
+#include <string.h>
+
+#define IFNAME0 's'
+#define IFNAME1 'm'
+
+typedef struct{
+	u16_t len;
+	u8_t data[ETH_SIM_MAX_FRAME];
+}ETH_SIM_FRAME;
+
+static ETH_SIM_FRAME _rxRing[ETH_SIM_RX_RING_SIZE];
+static int _rxIn;
+static int _rxOut;
+static int _rxCount;
+static pthread_mutex_t _rxMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static ETH_SIM_STATS _simStats;
+static FILE *_txPcap;
+
+static void low_level_init(struct netif *netif){
+	netif->hwaddr_len = ETH_HWADDR_LEN;
+	netif->hwaddr[0] = MAC_ADDR0;
+	netif->hwaddr[1] = MAC_ADDR1;
+	netif->hwaddr[2] = MAC_ADDR2;
+	netif->hwaddr[3] = MAC_ADDR3;
+	netif->hwaddr[4] = MAC_ADDR4;
+	netif->hwaddr[5] = MAC_ADDR5;
+	netif->mtu = 1500;
+	netif->flags |= NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
+
+	/* same order as the target driver */
+	GI_Init();
+	GI_STATS_INIT();
+	GI_Packet_Init();
+	GI_Ethernet_Init(netif);
+	GI_IPv4_Init(netif);
+}
+
+err_t ethernetif_init(struct netif *netif){
+	LWIP_ASSERT("netif != NULL", (netif != NULL));
+
+	netif->name[0] = IFNAME0;
+	netif->name[1] = IFNAME1;
+	netif->output = etharp_output;
+
+	low_level_init(netif);
+	return ERR_OK;
+}
+
+/**
+ * Stores a frame in the rx ring like the DMA would and raises the rx
+ * "interrupt". Returns -1 if the ring is full.
+ */
+int ethernetif_sim_rx(const u8_t *frame, u16_t len){
+	ETH_SIM_FRAME *slot;
+
+	if(len > ETH_SIM_MAX_FRAME)
+		len = ETH_SIM_MAX_FRAME;
+
+	pthread_mutex_lock(&_rxMutex);
+	if(_rxCount >= ETH_SIM_RX_RING_SIZE){
+		_simStats.rxRingFull++;
+		pthread_mutex_unlock(&_rxMutex);
+		ethernetif_sim_rx_irq();
+		return -1;
+	}
+	slot = &_rxRing[_rxIn];
+	memcpy(slot->data, frame, len);
+	slot->len = len;
+	_rxIn = (_rxIn + 1) % ETH_SIM_RX_RING_SIZE;
+	_rxCount++;
+	_simStats.rxFrames++;
+	pthread_mutex_unlock(&_rxMutex);
+
+	ethernetif_sim_rx_irq();
+	return 0;
+}
+
+/**
+ * The rx interrupt, interrupts are locked out by critical sections
+ */
+void ethernetif_sim_rx_irq(void){
+	OS_Sim_EnterCritical();
+	ethDownlinkInputFunction(NULL, NULL);
+	OS_Sim_ExitCritical();
+}
+
+int ethernetif_sim_rx_pending(void){
+	int count;
+	pthread_mutex_lock(&_rxMutex);
+	count = _rxCount;
+	pthread_mutex_unlock(&_rxMutex);
+	return count;
+}
+
+void ethernetif_sim_set_pcap(FILE *pcap){
+	_txPcap = pcap;
+}
+
+void ethernetif_sim_get_stats(ETH_SIM_STATS *stats){
+	pthread_mutex_lock(&_rxMutex);
+	*stats = _simStats;
+	pthread_mutex_unlock(&_rxMutex);
+}
+
+struct pbuf * low_level_input(struct netif *netif){
+	struct pbuf *p;
+	ETH_SIM_FRAME *slot;
+
+	LWIP_UNUSED_ARG(netif);
+
+	pthread_mutex_lock(&_rxMutex);
+	if(_rxCount == 0){
+		pthread_mutex_unlock(&_rxMutex);
+		return NULL;
+	}
+	slot = &_rxRing[_rxOut];
+	/* headroom for ETH_SEND_DATA if a reply reuses the pbuf, like the target */
+	p = pbuf_alloc(PBUF_RAW_TX, slot->len, PBUF_POOL);
+	if(p != NULL)
+		pbuf_take(p, slot->data, slot->len);
+	else
+		_simStats.rxNoPbuf++;
+	/* the descriptor is given back to the DMA in any case */
+	_rxOut = (_rxOut + 1) % ETH_SIM_RX_RING_SIZE;
+	_rxCount--;
+	pthread_mutex_unlock(&_rxMutex);
+	return p;
+}
+
+err_t low_level_output(struct netif *netif, struct pbuf *p){
+	LWIP_UNUSED_ARG(netif);
+
+	pthread_mutex_lock(&_rxMutex);
+	_simStats.txFrames++;
+	_simStats.txBytes += p->tot_len;
+	pthread_mutex_unlock(&_rxMutex);
+
+	if(_txPcap != NULL){
+		u8_t frame[ETH_SIM_MAX_FRAME];
+		u16_t len = pbuf_copy_partial(p, frame, sizeof(frame), 0);
+		u32_t rec[4];
+		u32_t now = OS_Sim_TimeUs();
+		rec[0] = now / 1000000u;
+		rec[1] = now % 1000000u;
+		rec[2] = len;
+		rec[3] = p->tot_len;
+		fwrite(rec, sizeof(rec), 1, _txPcap);
+		fwrite(frame, len, 1, _txPcap);
+	}
+	return ERR_OK;
+}
@@ -0,0 +1,33 @@
+/*
+ * ethernetif_sim.h
+ *
+ *  Created on: 17.10.2026
+ */
+
+#ifndef TEST_GI_SIM_ETHERNETIF_SIM_H_
+#define TEST_GI_SIM_ETHERNETIF_SIM_H_
+
+#include "ethernetif.h"
+#include <stdio.h>
+
+/* Same number of rx descriptors as the target */
+#ifndef ETH_SIM_RX_RING_SIZE
+#define ETH_SIM_RX_RING_SIZE				4
+#endif
+#define ETH_SIM_MAX_FRAME					1536
+
+typedef struct{
+	u32_t rxFrames;			/* stored in the ring */
+	u32_t rxRingFull;			/* refused, the ring was full */
+	u32_t rxNoPbuf;			/* taken from the ring but dropped */
+	u32_t txFrames;
+	u32_t txBytes;
+}ETH_SIM_STATS;
+
+int ethernetif_sim_rx(const u8_t *frame, u16_t len);
+void ethernetif_sim_rx_irq(void);
+int ethernetif_sim_rx_pending(void);
+void ethernetif_sim_set_pcap(FILE *pcap);
+void ethernetif_sim_get_stats(ETH_SIM_STATS *stats);
+
+#endif /* TEST_GI_SIM_ETHERNETIF_SIM_H_ */
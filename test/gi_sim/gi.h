@@ -0,0 +1,49 @@
+/*
+ * gi.h
+ *
+ *  Created on: 17.10.2026
+ *
+ * Stand-in for the GI runtime on the host. Same calls as on the target, every
+ * interface gets a pthread, but only one of them runs at a time: the ready
+ * interface with the best priority gets the cpu after each queue entry.
+ */
+
+#ifndef TEST_GI_SIM_GI_H_
+#define TEST_GI_SIM_GI_H_
+
+#include "ucos_ii.h"
+
+typedef int (*GI_LINK_FKT)(void* p_arg1, void* p_arg2);
+
+typedef struct{
+	OS_STK *p_taskStack;
+	INT8U prio;
+	INT32U stackSize;
+}GI_TASK_DATA;
+
+typedef struct gi_link{
+	GI_LINK_FKT _inputFkt;		/* posts p_arg2 to link p_arg1, 0 on success */
+	GI_LINK_FKT _outputFkt;		/* gets what the router returned for this link */
+	struct gi_interface *gi_if;
+	int id;
+	/* the buffer of the module holds 32 bit entries, pointers are larger on
+	 * the host, so the queue has its own storage */
+	void **queue;
+	int size;
+	int count;
+	int in;
+	int out;
+}GI_LINK;
+
+void GI_Init(void);
+int GI_AddInterface(int id, void *arg, void* (*processFkt)(void*, int),
+				int (*routerFkt)(void*, int, void*), GI_TASK_DATA *taskData);
+GI_LINK* GI_AddQueueLink(int ifId, int linkId, void *buffer, int size, GI_LINK_FKT outputFkt);
+
+/* Simulator only */
+void GI_Sim_Start(void);
+void GI_Sim_Lock(void);
+void GI_Sim_Unlock(void);
+void GI_Sim_WaitIdle(void);
+
+#endif /* TEST_GI_SIM_GI_H_ */
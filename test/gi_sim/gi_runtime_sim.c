@@ -0,0 +1,209 @@
+/*
+ * gi_runtime_sim.c
+ *
+ *  Created on: 17.10.2026
+ *
+ * GI runtime for the host build. Every interface is a pthread, a scheduler
+ * lock makes them behave like tasks on one cpu: an entry is processed to
+ * completion, then the ready interface with the best priority runs next.
+ * Within an interface the links are served round robin.
+ */
+
+#include "gi.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#ifndef GI_SIM_MAX_INTERFACES
+#define GI_SIM_MAX_INTERFACES				4
+#endif
+#ifndef GI_SIM_MAX_LINKS
+#define GI_SIM_MAX_LINKS					8
+#endif
+
+typedef struct gi_interface{
+	void* (*processFkt)(void*, int);
+	int (*routerFkt)(void*, int, void*);
+	INT8U prio;
+	GI_LINK links[GI_SIM_MAX_LINKS];
+	int numLinks;
+	int pending;				/* entries in all queues */
+	int next;					/* round robin position */
+	pthread_t thread;
+}GI_INTERFACE;
+
+static GI_INTERFACE _giIf[GI_SIM_MAX_INTERFACES];
+static int _giNumIf;
+
+static pthread_mutex_t _schedMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _schedCond = PTHREAD_COND_INITIALIZER;
+static int _cpuBusy;
+static int _lockWaiting;
+
+static int _giPost(void* p_arg1, void* p_arg2);
+static void* _giTask(void *arg);
+
+/**
+ * Init Function
+ */
+void GI_Init(void){
+	_giNumIf = 0;
+}
+
+/**
+ * Adds an interface, the interfaces are numbered in the order they are added
+ */
+int GI_AddInterface(int id, void *arg, void* (*processFkt)(void*, int),
+				int (*routerFkt)(void*, int, void*), GI_TASK_DATA *taskData){
+	GI_INTERFACE *gi_if;
+	if(_giNumIf >= GI_SIM_MAX_INTERFACES)
+		return -1;
+	gi_if = &_giIf[_giNumIf];
+	gi_if->processFkt = processFkt;
+	gi_if->routerFkt = routerFkt;
+	gi_if->prio = taskData->prio;
+	gi_if->numLinks = 0;
+	gi_if->pending = 0;
+	gi_if->next = 0;
+	return _giNumIf++;
+}
+
+GI_LINK* GI_AddQueueLink(int ifId, int linkId, void *buffer, int size, GI_LINK_FKT outputFkt){
+	GI_LINK *link;
+	if(ifId < 0 || ifId >= _giNumIf || linkId < 0 || linkId >= GI_SIM_MAX_LINKS || size <= 0)
+		return NULL;
+	link = &_giIf[ifId].links[linkId];
+	link->queue = (void**)calloc(size, sizeof(void*));
+	if(link->queue == NULL)
+		return NULL;
+	link->_inputFkt = _giPost;
+	link->_outputFkt = outputFkt;
+	link->gi_if = &_giIf[ifId];
+	link->id = linkId;
+	link->size = size;
+	link->count = 0;
+	link->in = 0;
+	link->out = 0;
+	if(linkId >= _giIf[ifId].numLinks)
+		_giIf[ifId].numLinks = linkId + 1;
+	return link;
+}
+
+/**
+ * Starts the interface tasks, after all modules are initialized
+ */
+void GI_Sim_Start(void){
+	int i;
+	for(i = 0; i < _giNumIf; i++){
+		if(pthread_create(&_giIf[i].thread, NULL, _giTask, &_giIf[i]) != 0){
+			fprintf(stderr, "gi_sim: could not start interface %d\n", i);
+			exit(1);
+		}
+	}
+}
+
+/**
+ * Takes the cpu from the interface tasks, e.g. to call into lwIP from main
+ */
+void GI_Sim_Lock(void){
+	pthread_mutex_lock(&_schedMutex);
+	_lockWaiting++;
+	while(_cpuBusy)
+		pthread_cond_wait(&_schedCond, &_schedMutex);
+	_lockWaiting--;
+	_cpuBusy = 1;
+	pthread_mutex_unlock(&_schedMutex);
+}
+
+void GI_Sim_Unlock(void){
+	pthread_mutex_lock(&_schedMutex);
+	_cpuBusy = 0;
+	pthread_cond_broadcast(&_schedCond);
+	pthread_mutex_unlock(&_schedMutex);
+}
+
+/**
+ * Waits until all queues are empty and no interface is running
+ */
+void GI_Sim_WaitIdle(void){
+	int i;
+	pthread_mutex_lock(&_schedMutex);
+	for(;;){
+		int pending = _cpuBusy;
+		for(i = 0; i < _giNumIf; i++)
+			pending += _giIf[i].pending;
+		if(pending == 0)
+			break;
+		pthread_cond_wait(&_schedCond, &_schedMutex);
+	}
+	pthread_mutex_unlock(&_schedMutex);
+}
+
+/* Has to be called with _schedMutex locked */
+static int _giMayRun(GI_INTERFACE *gi_if){
+	int i;
+	if(_cpuBusy || _lockWaiting || gi_if->pending == 0)
+		return 0;
+	for(i = 0; i < _giNumIf; i++){
+		if(_giIf[i].pending > 0 && _giIf[i].prio < gi_if->prio)
+			return 0;
+	}
+	return 1;
+}
+
+static int _giPost(void* p_arg1, void* p_arg2){
+	GI_LINK *link = (GI_LINK*)p_arg1;
+	pthread_mutex_lock(&_schedMutex);
+	if(link->count >= link->size){
+		pthread_mutex_unlock(&_schedMutex);
+		return -1;
+	}
+	link->queue[link->in] = p_arg2;
+	link->in = (link->in + 1) % link->size;
+	link->count++;
+	link->gi_if->pending++;
+	pthread_cond_broadcast(&_schedCond);
+	pthread_mutex_unlock(&_schedMutex);
+	return 0;
+}
+
+static void* _giTask(void *arg){
+	GI_INTERFACE *gi_if = (GI_INTERFACE*)arg;
+	for(;;){
+		GI_LINK *link = NULL;
+		void *data;
+		void *result;
+		int i;
+
+		pthread_mutex_lock(&_schedMutex);
+		while(!_giMayRun(gi_if))
+			pthread_cond_wait(&_schedCond, &_schedMutex);
+		for(i = 0; i < gi_if->numLinks; i++){
+			GI_LINK *l = &gi_if->links[(gi_if->next + i) % gi_if->numLinks];
+			if(l->count > 0){
+				link = l;
+				break;
+			}
+		}
+		gi_if->next = (link->id + 1) % gi_if->numLinks;
+		data = link->queue[link->out];
+		link->out = (link->out + 1) % link->size;
+		link->count--;
+		gi_if->pending--;
+		_cpuBusy = 1;
+		pthread_mutex_unlock(&_schedMutex);
+
+		result = gi_if->processFkt(data, link->id);
+		if(result != NULL){
+			int outId = gi_if->routerFkt(result, link->id, gi_if);
+			if(outId >= 0 && outId < gi_if->numLinks && gi_if->links[outId]._outputFkt != NULL)
+				gi_if->links[outId]._outputFkt(result, NULL);
+		}
+
+		pthread_mutex_lock(&_schedMutex);
+		_cpuBusy = 0;
+		pthread_cond_broadcast(&_schedCond);
+		pthread_mutex_unlock(&_schedMutex);
+	}
+	return NULL;
+}
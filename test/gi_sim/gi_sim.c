@@ -0,0 +1,292 @@
+/*
+ * gi_sim.c
+ *
+ *  Created on: 17.10.2026
+ *
+ * Runs recorded frames through the GI module pipeline on the host and reports
+ * packets/s and the per-link statistics of GI_STATS.
+ *
+ * gi_sim [-n rounds] [-e] [-u port] [-m mac] [-r link:prio:rate:burst] [-w tx.pcap] file...
+ *   file    pcap (ethernet) or one raw frame as in test/fuzz/inputs
+ *   -n      feed all frames this often (default 1000)
+ *   -e      echo UDP payload to the broadcast address, exercises the tx links
+ *   -u      UDP port to receive on (default 5000)
+ *   -m      replace the destination MAC of all frames, e.g. 02:00:00:00:00:02
+ *           for the critical class of the default classifier rules
+ *   -r      dispatch priority and rate limit of an ethernet uplink
+ *           (1 critical, 2 IPv4, 3 ARP), may be given more than once
+ *   -w      write transmitted frames to a pcap file
+ */
+
+#include "lwip/init.h"
+#include "lwip/netif.h"
+#include "lwip/udp.h"
+#include "lwip/tcp.h"
+#include "netif/ethernet.h"
+#include "lwip/prot/ethernet.h"
+#include "gi_modules/gi_stats.h"
+#include "gi_modules/gi_ethernet_module.h"
+#include "ethernetif_sim.h"
+#include "gi.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+
+#define SIM_MAX_FRAMES						4096
+#define SIM_MAX_SCHED						8
+
+#define PCAP_MAGIC							0xa1b2c3d4u
+#define PCAP_MAGIC_NS						0xa1b23c4du
+#define PCAP_LINKTYPE_ETHERNET				1
+
+typedef struct{
+	u16_t len;
+	u8_t *data;
+}SIM_FRAME;
+
+static SIM_FRAME _frames[SIM_MAX_FRAMES];
+static int _numFrames;
+
+static volatile u32_t _udpRx;
+static volatile u32_t _tcpAccepted;
+static int _echo;
+
+static u32_t _swap32(u32_t v){
+	return ((v & 0xff) << 24) | ((v & 0xff00) << 8) | ((v >> 8) & 0xff00) | (v >> 24);
+}
+
+static void _addFrame(const u8_t *data, u32_t len){
+	if(_numFrames >= SIM_MAX_FRAMES || len == 0)
+		return;
+	if(len > ETH_SIM_MAX_FRAME)
+		len = ETH_SIM_MAX_FRAME;
+	_frames[_numFrames].data = (u8_t*)malloc(len);
+	if(_frames[_numFrames].data == NULL)
+		return;
+	memcpy(_frames[_numFrames].data, data, len);
+	_frames[_numFrames].len = (u16_t)len;
+	_numFrames++;
+}
+
+/* pcap files give all their frames, anything else is one raw frame */
+static int _loadFile(const char *name){
+	FILE *f = fopen(name, "rb");
+	u32_t hdr[6];
+	u8_t buf[65536];
+	size_t len;
+
+	if(f == NULL){
+		perror(name);
+		return -1;
+	}
+	len = fread(hdr, 1, sizeof(hdr), f);
+	if(len == sizeof(hdr) && (hdr[0] == PCAP_MAGIC || hdr[0] == PCAP_MAGIC_NS ||
+			_swap32(hdr[0]) == PCAP_MAGIC || _swap32(hdr[0]) == PCAP_MAGIC_NS)){
+		int swapped = (hdr[0] != PCAP_MAGIC && hdr[0] != PCAP_MAGIC_NS);
+		u32_t linktype = swapped ? _swap32(hdr[5]) : hdr[5];
+		u32_t rec[4];
+		if(linktype != PCAP_LINKTYPE_ETHERNET){
+			fprintf(stderr, "%s: link type %u is not ethernet\n", name, (unsigned)linktype);
+			fclose(f);
+			return -1;
+		}
+		while(fread(rec, sizeof(rec), 1, f) == 1){
+			u32_t caplen = swapped ? _swap32(rec[2]) : rec[2];
+			if(caplen > sizeof(buf) || fread(buf, 1, caplen, f) != caplen)
+				break;
+			_addFrame(buf, caplen);
+		}
+	} else {
+		memcpy(buf, hdr, len);
+		len += fread(buf + len, 1, sizeof(buf) - len, f);
+		_addFrame(buf, (u32_t)len);
+	}
+	fclose(f);
+	return 0;
+}
+
+static void _udpRecv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+				const ip_addr_t *addr, u16_t port){
+	LWIP_UNUSED_ARG(arg);
+	LWIP_UNUSED_ARG(addr);
+	_udpRx++;
+	if(_echo)
+		udp_sendto(pcb, p, IP_ADDR_BROADCAST, port);
+	pbuf_free(p);
+}
+
+static err_t _tcpAccept(void *arg, struct tcp_pcb *newpcb, err_t err){
+	LWIP_UNUSED_ARG(arg);
+	LWIP_UNUSED_ARG(err);
+	_tcpAccepted++;
+	tcp_abort(newpcb);
+	return ERR_ABRT;
+}
+
+static void _printStats(void){
+	GI_LINK_STATS stats[GI_STATS_MAX_LINKS];
+	int n = GI_Stats_Snapshot(stats, GI_STATS_MAX_LINKS);
+	int i, b;
+
+	printf("\n%-12s %9s %9s %7s %5s %8s %8s %8s\n", "link", "enqueued", "dequeued",
+			"drops", "max", "min us", "avg us", "max us");
+	for(i = 0; i < n; i++){
+		GI_LINK_STATS *s = &stats[i];
+		if(s->dequeued == 0 && s->drops == 0)
+			continue;
+		printf("%-12s %9u %9u %7u %5u %8u %8.1f %8u\n", s->name,
+				(unsigned)s->enqueued, (unsigned)s->dequeued, (unsigned)s->drops,
+				(unsigned)s->maxDepth, s->dequeued ? (unsigned)s->latencyMin : 0,
+				s->dequeued ? (double)s->latencySum / s->dequeued : 0.0,
+				(unsigned)s->latencyMax);
+	}
+
+	printf("\nlatency histogram, bin n counts [2^(n-1), 2^n) us\n%-12s", "link");
+	for(b = 0; b < GI_STATS_HIST_BINS; b++)
+		printf(" %6d", b);
+	printf("\n");
+	for(i = 0; i < n; i++){
+		if(stats[i].dequeued == 0)
+			continue;
+		printf("%-12s", stats[i].name);
+		for(b = 0; b < GI_STATS_HIST_BINS; b++)
+			printf(" %6u", (unsigned)stats[i].hist[b]);
+		printf("\n");
+	}
+}
+
+int main(int argc, char** argv){
+	struct netif netif;
+	ip4_addr_t addr, netmask, gw;
+	struct udp_pcb *udp;
+	struct tcp_pcb *tcp;
+	ETH_SIM_STATS simStats;
+	FILE *pcap = NULL;
+	struct eth_addr dest;
+	int setDest = 0;
+	struct{
+		int linkId;
+		unsigned prio, rate, burst;
+	}sched[SIM_MAX_SCHED];
+	int numSched = 0;
+	long rounds = 1000;
+	u16_t udpPort = 5000;
+	u32_t start, elapsed;
+	long r;
+	int i, opt;
+
+	while((opt = getopt(argc, argv, "n:eu:m:r:w:")) != -1){
+		switch(opt){
+		case 'n':
+			rounds = strtol(optarg, NULL, 0);
+			break;
+		case 'e':
+			_echo = 1;
+			break;
+		case 'u':
+			udpPort = (u16_t)strtol(optarg, NULL, 0);
+			break;
+		case 'm':
+			if(sscanf(optarg, "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx", &dest.addr[0], &dest.addr[1],
+					&dest.addr[2], &dest.addr[3], &dest.addr[4], &dest.addr[5]) != 6){
+				fprintf(stderr, "invalid MAC address %s\n", optarg);
+				return 1;
+			}
+			setDest = 1;
+			break;
+		case 'r':
+			if(numSched >= SIM_MAX_SCHED || sscanf(optarg, "%d:%u:%u:%u", &sched[numSched].linkId,
+					&sched[numSched].prio, &sched[numSched].rate, &sched[numSched].burst) != 4){
+				fprintf(stderr, "invalid uplink setting %s\n", optarg);
+				return 1;
+			}
+			numSched++;
+			break;
+		case 'w':
+			pcap = fopen(optarg, "wb");
+			if(pcap == NULL){
+				perror(optarg);
+				return 1;
+			}
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-n rounds] [-e] [-u port] [-m mac] [-r link:prio:rate:burst] [-w tx.pcap] file...\n", argv[0]);
+			return 1;
+		}
+	}
+	for(i = optind; i < argc; i++)
+		_loadFile(argv[i]);
+	if(_numFrames == 0){
+		fprintf(stderr, "no frames to send\n");
+		return 1;
+	}
+	for(i = 0; setDest && i < _numFrames; i++){
+		if(_frames[i].len >= sizeof(struct eth_hdr))
+			memcpy(&((struct eth_hdr*)_frames[i].data)->dest, &dest, sizeof(dest));
+	}
+
+	if(pcap != NULL){
+		u32_t hdr[6] = {PCAP_MAGIC, 0x00040002u, 0, 0, 65535, PCAP_LINKTYPE_ETHERNET};
+		fwrite(hdr, sizeof(hdr), 1, pcap);
+		ethernetif_sim_set_pcap(pcap);
+	}
+
+	/* same addresses as test/fuzz, so its inputs are accepted */
+	lwip_init();
+	IP4_ADDR(&addr, 172, 30, 115, 84);
+	IP4_ADDR(&netmask, 255, 255, 255, 0);
+	IP4_ADDR(&gw, 172, 30, 115, 1);
+	netif_add(&netif, &addr, &netmask, &gw, NULL, ethernetif_init, ethernet_input);
+	netif_set_default(&netif);
+	netif_set_up(&netif);
+	netif_set_link_up(&netif);
+
+	udp = udp_new();
+	udp_bind(udp, IP_ADDR_ANY, udpPort);
+	udp_recv(udp, _udpRecv, NULL);
+	tcp = tcp_new();
+	tcp_bind(tcp, IP_ADDR_ANY, 80);
+	tcp = tcp_listen(tcp);
+	tcp_accept(tcp, _tcpAccept);
+
+	for(i = 0; i < numSched; i++){
+		if(GI_Ethernet_SetUplinkSched(sched[i].linkId, (u8_t)sched[i].prio, sched[i].rate, sched[i].burst) != 0)
+			fprintf(stderr, "invalid uplink %d\n", sched[i].linkId);
+	}
+
+	GI_Sim_Start();
+
+	start = OS_Sim_TimeUs();
+	for(r = 0; r < rounds; r++){
+		for(i = 0; i < _numFrames; i++){
+			/* the MAC would drop here, the simulator waits for the ring */
+			while(ethernetif_sim_rx(_frames[i].data, _frames[i].len) != 0)
+				sched_yield();
+		}
+	}
+	/* frames left behind while the ethernet task was paused */
+	for(;;){
+		GI_Sim_WaitIdle();
+		if(ethernetif_sim_rx_pending() == 0)
+			break;
+		ethernetif_sim_rx_irq();
+	}
+	elapsed = OS_Sim_TimeUs() - start;
+
+	ethernetif_sim_get_stats(&simStats);
+	printf("%u frames in %.3f s, %.0f packets/s\n", (unsigned)simStats.rxFrames,
+			elapsed / 1e6, elapsed ? simStats.rxFrames * 1e6 / elapsed : 0.0);
+	printf("rx ring full %u, no pbuf %u, udp received %u, tcp accepted %u, tx frames %u\n",
+			(unsigned)simStats.rxRingFull, (unsigned)simStats.rxNoPbuf, (unsigned)_udpRx,
+			(unsigned)_tcpAccepted, (unsigned)simStats.txFrames);
+	printf("rate limit drops, uplink 1: %u 2: %u 3: %u\n", (unsigned)GI_Ethernet_GetUplinkDrops(1),
+			(unsigned)GI_Ethernet_GetUplinkDrops(2), (unsigned)GI_Ethernet_GetUplinkDrops(3));
+	_printStats();
+
+	if(pcap != NULL)
+		fclose(pcap);
+	return 0;
+}
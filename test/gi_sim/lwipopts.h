@@ -0,0 +1,38 @@
+/*
+ * lwipopts.h
+ *
+ *  Created on: 17.10.2026
+ */
+
+#ifndef LWIP_HDR_LWIPOPTS_H__
+#define LWIP_HDR_LWIPOPTS_H__
+
+/* The GI modules replace the tcpip thread, no sys_arch needed */
+#define NO_SYS                          1
+#define LWIP_NETCONN                    0
+#define LWIP_SOCKET                     0
+#define SYS_LIGHTWEIGHT_PROT            0
+#define LWIP_IPV6                       0
+#define LWIP_IGMP                       1
+#define ETHARP_SUPPORT_STATIC_ENTRIES   1
+
+/* Recorded traffic rarely has valid checksums after editing */
+#define CHECKSUM_CHECK_IP               0
+#define CHECKSUM_CHECK_UDP              0
+#define CHECKSUM_CHECK_TCP              0
+#define CHECKSUM_CHECK_ICMP             0
+
+#define MEM_SIZE                        64000
+#define PBUF_POOL_SIZE                  256
+#define MEMP_NUM_TCP_PCB                8
+#define TCP_SND_QUEUELEN                40
+#define MEMP_NUM_TCP_SEG                TCP_SND_QUEUELEN
+
+/* Headroom for ETH_SEND_DATA in front of the ethernet header */
+#define PBUF_LINK_ENCAPSULATION_HLEN    32
+
+/* Per-link statistics of the GI modules, in microseconds */
+#define GI_STATS                        1
+#define GI_STATS_TIME()                 OS_Sim_TimeUs()
+
+#endif /* LWIP_HDR_LWIPOPTS_H__ */
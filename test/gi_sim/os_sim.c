@@ -0,0 +1,170 @@
+/*
+ * os_sim.c
+ *
+ *  Created on: 17.10.2026
+ *
+ * uC/OS-II shim for the host build, just enough for the GI modules
+ */
+
+#include "ucos_ii.h"
+#include "lwip/sys.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct os_event{
+	pthread_mutex_t mutex;
+};
+
+static pthread_mutex_t _criticalMutex;
+static pthread_once_t _criticalOnce = PTHREAD_ONCE_INIT;
+static struct timespec _startTime;
+
+static void _criticalInit(void){
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&_criticalMutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+	clock_gettime(CLOCK_MONOTONIC, &_startTime);
+}
+
+/**
+ * Critical sections, interrupts are threads that take the same lock
+ */
+void OS_Sim_EnterCritical(void){
+	pthread_once(&_criticalOnce, _criticalInit);
+	pthread_mutex_lock(&_criticalMutex);
+}
+
+void OS_Sim_ExitCritical(void){
+	pthread_mutex_unlock(&_criticalMutex);
+}
+
+/**
+ * Time Functions
+ */
+static uint64_t _timeUs(void){
+	struct timespec now;
+	pthread_once(&_criticalOnce, _criticalInit);
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)(now.tv_sec - _startTime.tv_sec) * 1000000u +
+			(now.tv_nsec - _startTime.tv_nsec) / 1000;
+}
+
+INT32U OS_Sim_TimeUs(void){
+	return (INT32U)_timeUs();
+}
+
+INT32U OSTimeGet(void){
+	return (INT32U)(_timeUs() / (1000000u / OS_TICKS_PER_SEC));
+}
+
+u32_t sys_now(void){
+	return (u32_t)(_timeUs() / 1000u);
+}
+
+/**
+ * Mutexes
+ */
+OS_EVENT* OSMutexCreate(INT8U prio, INT8U *perr){
+	OS_EVENT *pevent = (OS_EVENT*)malloc(sizeof(OS_EVENT));
+	(void)prio;
+	if(pevent == NULL){
+		*perr = OS_ERR_PEVENT_NULL;
+		return NULL;
+	}
+	pthread_mutex_init(&pevent->mutex, NULL);
+	*perr = OS_ERR_NONE;
+	return pevent;
+}
+
+void OSMutexPend(OS_EVENT *pevent, INT32U timeout, INT8U *perr){
+	(void)timeout;
+	pthread_mutex_lock(&pevent->mutex);
+	*perr = OS_ERR_NONE;
+}
+
+INT8U OSMutexPost(OS_EVENT *pevent){
+	pthread_mutex_unlock(&pevent->mutex);
+	return OS_ERR_NONE;
+}
+
+/**
+ * Memory Partitions, a free list through the blocks like uC/OS-II
+ */
+OS_MEM* OSMemCreate(void *addr, INT32U nblks, INT32U blksize, INT8U *perr){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	OS_MEM *pmem;
+	uint8_t *blk = (uint8_t*)addr;
+	INT32U i;
+
+	if(addr == NULL){
+		*perr = OS_ERR_MEM_INVALID_PART;
+		return NULL;
+	}
+	if(nblks < 2){
+		*perr = OS_ERR_MEM_INVALID_BLKS;
+		return NULL;
+	}
+	if(blksize < sizeof(void*)){
+		*perr = OS_ERR_MEM_INVALID_SIZE;
+		return NULL;
+	}
+	pmem = (OS_MEM*)malloc(sizeof(OS_MEM));
+	if(pmem == NULL){
+		*perr = OS_ERR_MEM_INVALID_PART;
+		return NULL;
+	}
+	for(i = 0; i < nblks - 1; i++)
+		*(void**)(blk + i * blksize) = blk + (i + 1) * blksize;
+	*(void**)(blk + i * blksize) = NULL;
+
+	OS_ENTER_CRITICAL();
+	pmem->OSMemAddr = addr;
+	pmem->OSMemFreeList = addr;
+	pmem->OSMemBlkSize = blksize;
+	pmem->OSMemNBlks = nblks;
+	pmem->OSMemNFree = nblks;
+	OS_EXIT_CRITICAL();
+	*perr = OS_ERR_NONE;
+	return pmem;
+}
+
+void* OSMemGet(OS_MEM *pmem, INT8U *perr){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	void *pblk;
+
+	OS_ENTER_CRITICAL();
+	if(pmem->OSMemNFree == 0){
+		OS_EXIT_CRITICAL();
+		*perr = OS_ERR_MEM_NO_FREE_BLKS;
+		return NULL;
+	}
+	pblk = pmem->OSMemFreeList;
+	pmem->OSMemFreeList = *(void**)pblk;
+	pmem->OSMemNFree--;
+	OS_EXIT_CRITICAL();
+	*perr = OS_ERR_NONE;
+	return pblk;
+}
+
+INT8U OSMemPut(OS_MEM *pmem, void *pblk){
+#if OS_CRITICAL_METHOD == 3
+	OS_CPU_SR  cpu_sr = 0;
+#endif
+	OS_ENTER_CRITICAL();
+	if(pmem->OSMemNFree >= pmem->OSMemNBlks){
+		OS_EXIT_CRITICAL();
+		return OS_ERR_MEM_FULL;
+	}
+	*(void**)pblk = pmem->OSMemFreeList;
+	pmem->OSMemFreeList = pblk;
+	pmem->OSMemNFree++;
+	OS_EXIT_CRITICAL();
+	return OS_ERR_NONE;
+}
@@ -0,0 +1,19 @@
+/*
+ * stm32f7xx_hal_conf.h
+ *
+ *  Created on: 17.10.2026
+ *
+ * Only the MAC address of the board configuration is used by the GI modules
+ */
+
+#ifndef TEST_GI_SIM_STM32F7XX_HAL_CONF_H_
+#define TEST_GI_SIM_STM32F7XX_HAL_CONF_H_
+
+#define MAC_ADDR0   2U
+#define MAC_ADDR1   0U
+#define MAC_ADDR2   0U
+#define MAC_ADDR3   0U
+#define MAC_ADDR4   0U
+#define MAC_ADDR5   0U
+
+#endif /* TEST_GI_SIM_STM32F7XX_HAL_CONF_H_ */
@@ -0,0 +1,68 @@
+/*
+ * ucos_ii.h
+ *
+ *  Created on: 17.10.2026
+ *
+ * Host shim of the uC/OS-II subset used by the GI modules. Critical sections
+ * are one recursive pthread mutex, time comes from CLOCK_MONOTONIC.
+ */
+
+#ifndef TEST_GI_SIM_UCOS_II_H_
+#define TEST_GI_SIM_UCOS_II_H_
+
+#include <stdint.h>
+
+typedef uint8_t		BOOLEAN;
+typedef uint8_t		INT8U;
+typedef int8_t		INT8S;
+typedef uint16_t	INT16U;
+typedef int16_t		INT16S;
+typedef uint32_t	INT32U;
+typedef int32_t		INT32S;
+typedef uint32_t	OS_STK;
+typedef uint32_t	OS_CPU_SR;
+
+#define OS_TICKS_PER_SEC				1000u
+
+#define OS_ERR_NONE						0u
+#define OS_ERR_MEM_INVALID_PART			90u
+#define OS_ERR_MEM_INVALID_BLKS			91u
+#define OS_ERR_MEM_INVALID_SIZE			92u
+#define OS_ERR_MEM_NO_FREE_BLKS			93u
+#define OS_ERR_MEM_FULL					94u
+#define OS_ERR_PEVENT_NULL				4u
+#define OS_ERR_CREATE_ISR				141u
+
+#define OS_CRITICAL_METHOD				3u
+
+void OS_Sim_EnterCritical(void);
+void OS_Sim_ExitCritical(void);
+
+#define OS_ENTER_CRITICAL()				do { (void)cpu_sr; OS_Sim_EnterCritical(); } while(0)
+#define OS_EXIT_CRITICAL()				OS_Sim_ExitCritical()
+
+typedef struct os_mem{
+	void *OSMemAddr;
+	void *OSMemFreeList;
+	INT32U OSMemBlkSize;
+	INT32U OSMemNBlks;
+	INT32U OSMemNFree;
+}OS_MEM;
+
+OS_MEM* OSMemCreate(void *addr, INT32U nblks, INT32U blksize, INT8U *perr);
+void* OSMemGet(OS_MEM *pmem, INT8U *perr);
+INT8U OSMemPut(OS_MEM *pmem, void *pblk);
+
+/* Mutexes without priority inheritance, the simulated tasks do not preempt */
+typedef struct os_event OS_EVENT;
+
+OS_EVENT* OSMutexCreate(INT8U prio, INT8U *perr);
+void OSMutexPend(OS_EVENT *pevent, INT32U timeout, INT8U *perr);
+INT8U OSMutexPost(OS_EVENT *pevent);
+
+INT32U OSTimeGet(void);
+
+/* Microseconds since start, used as GI_STATS_TIME */
+INT32U OS_Sim_TimeUs(void);
+
+#endif /* TEST_GI_SIM_UCOS_II_H_ */
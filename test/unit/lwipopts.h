@@ -37,6 +37,7 @@
 #define LWIP_IPV6                       1
 
 #define LWIP_CHECKSUM_ON_COPY           1
+#define LWIP_CHECKSUM_RX_OFFLOAD        1
 #define TCP_CHECKSUM_ON_COPY_SANITY_CHECK 1
 #define TCP_CHECKSUM_ON_COPY_SANITY_CHECK_FAIL(printfmsg) LWIP_ASSERT("TCP_CHECKSUM_ON_COPY_SANITY_CHECK_FAIL", 0)
 
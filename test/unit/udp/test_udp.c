@@ -2,6 +2,10 @@
 
 #include "lwip/udp.h"
 #include "lwip/stats.h"
+#include "lwip/ip4.h"
+#include "lwip/inet_chksum.h"
+#include "lwip/prot/ip4.h"
+#include "lwip/prot/udp.h"
 
 #if !LWIP_STATS || !UDP_STATS || !MEMP_STATS
 #error "This tests needs UDP- and MEMP-statistics enabled"
@@ -22,6 +26,75 @@ udp_remove_all(void)
   fail_unless(MEMP_STATS_GET(used, MEMP_UDP_PCB) == 0);
 }
 
+#if LWIP_CHECKSUM_RX_OFFLOAD
+#define TEST_UDP_RX_PORT 7777
+static int udp_rx_count;
+
+static void
+udp_rx_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+{
+  LWIP_UNUSED_ARG(arg);
+  LWIP_UNUSED_ARG(pcb);
+  LWIP_UNUSED_ARG(addr);
+  LWIP_UNUSED_ARG(port);
+  udp_rx_count++;
+  pbuf_free(p);
+}
+
+/* Feeds an IPv4/UDP packet to ip4_input as a driver with checksum offload would,
+   the UDP checksum is correct unless bad_chksum is set */
+static void
+udp_rx_input(u8_t pbuf_flags, int bad_chksum)
+{
+  struct netif *input_netif = netif_list; /* just use any netif */
+  struct pbuf *p;
+  struct ip_hdr *iphdr;
+  struct udp_hdr *udphdr;
+  ip4_addr_t src;
+  err_t err;
+
+  p = pbuf_alloc(PBUF_RAW, sizeof(struct ip_hdr) + UDP_HLEN + 16, PBUF_RAM);
+  fail_unless(p != NULL);
+  if (p == NULL) {
+    return;
+  }
+  ip4_addr_copy(src, *netif_ip4_addr(input_netif));
+  src.addr = lwip_htonl(lwip_htonl(src.addr) + 1);
+
+  fail_unless(pbuf_remove_header(p, sizeof(struct ip_hdr)) == 0);
+  udphdr = (struct udp_hdr *)p->payload;
+  udphdr->src = lwip_htons(1234);
+  udphdr->dest = lwip_htons(TEST_UDP_RX_PORT);
+  udphdr->len = lwip_htons(p->tot_len);
+  udphdr->chksum = 0;
+  udphdr->chksum = inet_chksum_pseudo(p, IP_PROTO_UDP, p->tot_len, &src, netif_ip4_addr(input_netif));
+  if (bad_chksum) {
+    udphdr->chksum = (u16_t)~udphdr->chksum;
+  }
+  fail_unless(pbuf_add_header(p, sizeof(struct ip_hdr)) == 0);
+
+  iphdr = (struct ip_hdr *)p->payload;
+  IPH_VHL_SET(iphdr, 4, sizeof(struct ip_hdr) / 4);
+  IPH_TOS_SET(iphdr, 0);
+  IPH_LEN_SET(iphdr, lwip_htons(p->tot_len));
+  IPH_ID_SET(iphdr, 0);
+  IPH_OFFSET_SET(iphdr, 0);
+  IPH_TTL_SET(iphdr, 5);
+  IPH_PROTO_SET(iphdr, IP_PROTO_UDP);
+  IPH_CHKSUM_SET(iphdr, 0);
+  ip4_addr_copy(iphdr->src, src);
+  ip4_addr_copy(iphdr->dest, *netif_ip4_addr(input_netif));
+  IPH_CHKSUM_SET(iphdr, inet_chksum(iphdr, sizeof(struct ip_hdr)));
+
+  p->flags |= pbuf_flags;
+  err = ip4_input(p, input_netif);
+  if (err != ERR_OK) {
+    pbuf_free(p);
+  }
+  fail_unless(err == ERR_OK);
+}
+#endif /* LWIP_CHECKSUM_RX_OFFLOAD */
+
 /* Setups/teardown functions */
 
 static void
@@ -58,6 +131,47 @@ START_TEST(test_udp_new_remove)
 }
 END_TEST
 
+START_TEST(test_udp_rx_checksum_offload)
+{
+#if LWIP_CHECKSUM_RX_OFFLOAD
+  struct udp_pcb* pcb;
+  u16_t chkerr;
+  LWIP_UNUSED_ARG(_i);
+
+  pcb = udp_new();
+  fail_unless(pcb != NULL);
+  if (pcb == NULL) {
+    return;
+  }
+  fail_unless(udp_bind(pcb, IP4_ADDR_ANY, TEST_UDP_RX_PORT) == ERR_OK);
+  udp_recv(pcb, udp_rx_recv, NULL);
+  udp_rx_count = 0;
+  chkerr = lwip_stats.udp.chkerr;
+
+  /* no flag: checked in software */
+  udp_rx_input(0, 0);
+  fail_unless(udp_rx_count == 1);
+  udp_rx_input(0, 1);
+  fail_unless(udp_rx_count == 1);
+  fail_unless(lwip_stats.udp.chkerr == chkerr + 1);
+
+  /* verified by the MAC: not checked again */
+  udp_rx_input(PBUF_FLAG_CSUM_OK, 1);
+  fail_unless(udp_rx_count == 2);
+  fail_unless(lwip_stats.udp.chkerr == chkerr + 1);
+
+  /* error found by the MAC: dropped without a software check */
+  udp_rx_input(PBUF_FLAG_CSUM_BAD, 0);
+  fail_unless(udp_rx_count == 2);
+  fail_unless(lwip_stats.udp.chkerr == chkerr + 2);
+
+  udp_remove(pcb);
+#else
+  LWIP_UNUSED_ARG(_i);
+#endif /* LWIP_CHECKSUM_RX_OFFLOAD */
+}
+END_TEST
+
 
 /** Create the suite including all tests for this module */
 Suite *
@@ -65,6 +179,7 @@ udp_suite(void)
 {
   testfunc tests[] = {
     TESTFUNC(test_udp_new_remove),
+    TESTFUNC(test_udp_rx_checksum_offload),
   };
   return create_suite("UDP", tests, sizeof(tests)/sizeof(testfunc), udp_setup, udp_teardown);
 }